@@ -0,0 +1,80 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CARTESIANBENCHMARK_HPP
+#define CARTESIANBENCHMARK_HPP
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <regilo/cartesian.hpp>
+
+#include "statistics.hpp"
+
+/**
+ * Convert the scan to points record by record with std::cos and std::sin (the way the examples used to do it).
+ */
+template<typename T>
+std::size_t toCartesianNaive(const regilo::ScanData& data, std::vector<regilo::Point<T>>& points, const regilo::Pose& pose)
+{
+	points.clear();
+	for(const regilo::ScanRecord& record : data)
+	{
+		if(record.error) continue;
+
+		double angle = record.angle + pose.theta;
+		points.emplace_back(T(pose.x + record.distance * std::cos(angle)), T(pose.y + record.distance * std::sin(angle)));
+	}
+
+	return points.size();
+}
+
+/**
+ * Convert the scan count times with the given function and measure the duration of every conversion.
+ */
+template<typename T, typename Function>
+void runCartesianBenchmark(const std::string& name, const regilo::ScanData& data, std::size_t count, Function toCartesian)
+{
+	std::vector<regilo::Point<T>> points;
+	regilo::Pose pose(100, -50, 0.5);
+
+	Statistics duration;
+	duration.reserve(count);
+
+	std::size_t total = 0;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		total += toCartesian(data, points, pose);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		duration.add(std::chrono::duration<double, std::nano>(end - start).count());
+	}
+
+	std::cout << name << ": " << count << " scans (" << total << " points)" << std::endl;
+	std::cout << "  duration: ";
+	duration.print(std::cout, " ns");
+	std::cout << std::endl;
+}
+
+#endif // CARTESIANBENCHMARK_HPP
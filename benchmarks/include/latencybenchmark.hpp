@@ -0,0 +1,90 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LATENCYBENCHMARK_HPP
+#define LATENCYBENCHMARK_HPP
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "simulators/simulator.hpp"
+
+#include "statistics.hpp"
+
+/**
+ * Replay one scan response from a log file count times through the simulator at the maximum rate
+ * and measure the round-trip latency of every getScan() call.
+ */
+template<typename Controller, typename SimulatorT, typename... SimulatorArgs>
+void runLatencyBenchmark(const std::string& name, const std::string& logPath, const std::string& scanCommand,
+						 const std::string& responseEnd, std::size_t count, const SimulatorArgs& ... simulatorArgs)
+{
+	std::stringstream logStream(SimulatorT::createRepeatedLog(logPath, scanCommand, count));
+
+	SimulatorT simulator(logStream, simulatorArgs...);
+	simulator.responseEnd = responseEnd;
+	simulator.start();
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	Statistics latency;
+	latency.reserve(count);
+
+	std::size_t records = 0;
+	std::chrono::steady_clock::time_point start, end;
+
+	{
+		Controller controller;
+		controller.connect(simulator.getEndpoint());
+
+		start = std::chrono::steady_clock::now();
+		for(std::size_t i = 0; i < count; i++)
+		{
+			std::chrono::steady_clock::time_point scanStart = std::chrono::steady_clock::now();
+			regilo::ScanData data = controller.getScan();
+			std::chrono::steady_clock::time_point scanEnd = std::chrono::steady_clock::now();
+
+			latency.add(std::chrono::duration<double, std::micro>(scanEnd - scanStart).count());
+			records += data.size();
+		}
+		end = std::chrono::steady_clock::now();
+	}
+
+	if(deviceThread.joinable()) deviceThread.join();
+	if(!deviceStatus) throw std::runtime_error("The simulator of " + name + " failed.");
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	std::cout << name << ": " << count << " scans (" << records << " records) in " << seconds << " s, "
+			  << count / seconds << " scans/s" << std::endl;
+	std::cout << "  latency: ";
+	latency.print(std::cout, " us");
+	std::cout << std::endl;
+}
+
+#endif // LATENCYBENCHMARK_HPP
@@ -0,0 +1,48 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+#include <iostream>
+#include <vector>
+
+class Statistics
+{
+private:
+	std::vector<double> samples;
+	bool sorted = true;
+
+	void sort();
+
+public:
+	inline void reserve(std::size_t count) { samples.reserve(count); }
+	void add(double sample);
+
+	inline std::size_t count() const { return samples.size(); }
+	double sum() const;
+	double mean() const;
+	double percentile(double p);
+
+	void print(std::ostream& out, const std::string& unit);
+};
+
+#endif // STATISTICS_HPP
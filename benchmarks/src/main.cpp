@@ -0,0 +1,214 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include <regilo/hokuyocontroller.hpp>
+#include <regilo/neatocontroller.hpp>
+
+#include <regilo/version.hpp>
+
+#include "simulators/serialsimulator.hpp"
+#include "simulators/socketsimulator.hpp"
+
+#include "cartesianbenchmark.hpp"
+#include "latencybenchmark.hpp"
+
+struct Arguments
+{
+	std::vector<std::string> controllers;
+	std::string benchmark;
+	std::size_t count = 1000;
+	bool help = false;
+};
+
+void printHelp();
+void parseArgs(int argc, char **argv, Arguments& args);
+
+void runLatency(const std::string& controller, std::size_t count);
+void runCartesian(const std::string& device, std::size_t count);
+
+int main(int argc, char **argv)
+{
+	Arguments args;
+	try
+	{
+		parseArgs(argc, argv, args);
+	}
+	catch(std::invalid_argument& e)
+	{
+		std::cout << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+
+	if(args.help)
+	{
+		printHelp();
+		return 0;
+	}
+
+	try
+	{
+		if(args.benchmark == "latency")
+		{
+			for(const std::string& controller : args.controllers)
+			{
+				runLatency(controller, args.count);
+			}
+		}
+		else if(args.benchmark == "cartesian")
+		{
+			std::set<std::string> devices;
+			for(const std::string& controller : args.controllers)
+			{
+				std::string device = controller.substr(0, controller.find(':'));
+				if(devices.insert(device).second) runCartesian(device, args.count);
+			}
+		}
+	}
+	catch(std::exception& e)
+	{
+		std::cout << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+void runLatency(const std::string& controller, std::size_t count)
+{
+	std::string neatoLogPath = "data/neato-log-scan-move-time.txt";
+	std::string neatoScanCommand = regilo::NeatoSerialController::CMD_GET_LDS_SCAN.str();
+	std::string neatoResponseEnd(1, 0x1a);
+
+	std::string hokuyoLogPath = "data/hokuyo-log-scan-version.txt";
+	std::string hokuyoScanCommand = "G00076801";
+	std::string hokuyoResponseEnd = "\n\n";
+
+	if(controller == "neato:serial")
+	{
+		runLatencyBenchmark<regilo::NeatoSerialController, SerialSimulator>(controller, neatoLogPath, neatoScanCommand, neatoResponseEnd, count);
+	}
+	else if(controller == "neato:socket")
+	{
+		runLatencyBenchmark<regilo::NeatoSocketController, SocketSimulator>(controller, neatoLogPath, neatoScanCommand, neatoResponseEnd, count, 0);
+	}
+	else if(controller == "hokuyo:serial")
+	{
+		runLatencyBenchmark<regilo::HokuyoSerialController, SerialSimulator>(controller, hokuyoLogPath, hokuyoScanCommand, hokuyoResponseEnd, count);
+	}
+	else if(controller == "hokuyo:socket")
+	{
+		runLatencyBenchmark<regilo::HokuyoSocketController, SocketSimulator>(controller, hokuyoLogPath, hokuyoScanCommand, hokuyoResponseEnd, count, 0);
+	}
+}
+
+void runCartesian(const std::string& device, std::size_t count)
+{
+	regilo::ScanData data;
+	if(device == "neato")
+	{
+		regilo::NeatoSerialController neato("data/neato-log-scan-move-time.txt");
+		data = neato.getScan(false);
+	}
+	else
+	{
+		regilo::HokuyoSerialController hokuyo("data/hokuyo-log-scan-version.txt");
+		data = hokuyo.getScan(false);
+	}
+
+	typedef regilo::Point<float> PointF;
+	typedef regilo::Point<double> PointD;
+
+	runCartesianBenchmark<double>(device + " naive (double)", data, count, toCartesianNaive<double>);
+	runCartesianBenchmark<double>(device + " toCartesian (double)", data, count,
+		static_cast<std::size_t (*)(const regilo::ScanData&, std::vector<PointD>&, const regilo::Pose&)>(regilo::toCartesian));
+	runCartesianBenchmark<float>(device + " naive (float)", data, count, toCartesianNaive<float>);
+	runCartesianBenchmark<float>(device + " toCartesian (float)", data, count,
+		static_cast<std::size_t (*)(const regilo::ScanData&, std::vector<PointF>&, const regilo::Pose&)>(regilo::toCartesian));
+	runCartesianBenchmark<double>(device + " toCartesian deskew (double)", data, count,
+		[] (const regilo::ScanData& data, std::vector<PointD>& points, const regilo::Pose& pose)
+		{
+			return regilo::toCartesian(data, points, regilo::Pose(pose.x - 40, pose.y, pose.theta - 0.2), pose);
+		});
+}
+
+void printHelp()
+{
+	std::cout << "Usage: benchmarks [options] <benchmark>" << std::endl
+			  << "Arguments:" << std::endl
+			  << "  <benchmark>   The benchmark name. It can be \"latency\" (the getScan() round" << std::endl
+			  << "                trip through the test simulators) or \"cartesian\" (the scan" << std::endl
+			  << "                conversion to points, the protocol part of -c is ignored)." << std::endl
+			  << std::endl
+			  << "Options:" << std::endl
+			  << "  -c <name>     The controller name in the format \"device:protocol\". The device" << std::endl
+			  << "                part can be \"neato\" or \"hokuyo\". The protocol part can be" << std::endl
+			  << "                \"socket\" or \"serial\". It can be used more times (default: all)." << std::endl
+			  << "  -n <count>    The number of iterations (default: 1000)." << std::endl
+			  << "  -h, --help    Show this help." << std::endl
+			  << std::endl
+			  << "Using regilo-" << regilo::Version::VERSION << std::endl;
+}
+
+void parseArgs(int argc, char **argv, Arguments& args)
+{
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+
+		if(arg == "-c" || arg == "-n")
+		{
+			if(i + 1 >= argc) throw std::invalid_argument("Missing value of \"" + arg + "\".");
+			std::string value(argv[++i]);
+
+			if(arg == "-c")
+			{
+				if(value != "neato:serial" && value != "neato:socket" && value != "hokuyo:serial" && value != "hokuyo:socket")
+					throw std::invalid_argument("Unknown controller \"" + value + "\".");
+
+				args.controllers.push_back(value);
+			}
+			else args.count = std::stoul(value);
+		}
+		else if(arg == "-h" || arg == "--help")
+		{
+			args.help = true;
+			return;
+		}
+		else if(arg.front() != '-')
+		{
+			if(arg != "latency" && arg != "cartesian") throw std::invalid_argument("Unknown benchmark \"" + arg + "\".");
+			args.benchmark = arg;
+		}
+		else throw std::invalid_argument("Unknown argument \"" + arg + "\".");
+	}
+
+	if(args.benchmark.empty())
+		throw std::invalid_argument("Missing benchmark (see -h for more details).");
+
+	if(args.controllers.empty())
+	{
+		args.controllers = { "neato:serial", "neato:socket", "hokuyo:serial", "hokuyo:socket" };
+	}
+}
@@ -0,0 +1,74 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+void Statistics::sort()
+{
+	if(!sorted)
+	{
+		std::sort(samples.begin(), samples.end());
+		sorted = true;
+	}
+}
+
+void Statistics::add(double sample)
+{
+	samples.push_back(sample);
+	sorted = false;
+}
+
+double Statistics::sum() const
+{
+	return std::accumulate(samples.begin(), samples.end(), 0.0);
+}
+
+double Statistics::mean() const
+{
+	if(samples.empty()) return 0;
+	return sum() / samples.size();
+}
+
+double Statistics::percentile(double p)
+{
+	if(samples.empty()) return 0;
+	sort();
+
+	std::size_t index = std::size_t(std::ceil(p / 100 * samples.size()));
+	if(index > 0) index--;
+	if(index >= samples.size()) index = samples.size() - 1;
+
+	return samples.at(index);
+}
+
+void Statistics::print(std::ostream& out, const std::string& unit)
+{
+	out << "min " << percentile(0) << unit
+		<< ", mean " << mean() << unit
+		<< ", p50 " << percentile(50) << unit
+		<< ", p90 " << percentile(90) << unit
+		<< ", p99 " << percentile(99) << unit
+		<< ", max " << percentile(100) << unit;
+}
@@ -21,7 +21,6 @@
 
 #include <chrono>
 #include <iostream>
-#include <thread>
 
 #include <regilo/hokuyocontroller.hpp>
 #include <regilo/neatocontroller.hpp>
@@ -37,6 +36,7 @@ struct Arguments
 	std::string protocol;
 	std::string endpoint;
 	std::string logPath;
+	std::string cacheDirectory;
 	bool help = false;
 };
 
@@ -105,9 +105,18 @@ int main(int argc, char **argv)
 
 		neatoController->setLdsRotation(true);
 		std::cout << "LDS rotation: " << neatoController->getLdsRotation() << std::endl;
+
+		bool ready = neatoController->waitForLds(std::chrono::seconds(10));
+		std::cout << "LDS ready: " << ready << std::endl;
 	}
+	else if(fromDevice && args.device == "hokuyo")
+	{
+		bool loaded = hokuyoController->loadGeometry(args.cacheDirectory);
+		std::cout << "Geometry loaded: " << loaded << std::endl;
 
-	std::this_thread::sleep_for(std::chrono::seconds(3));
+		bool ready = hokuyoController->waitForLaser(std::chrono::seconds(10));
+		std::cout << "Laser ready: " << ready << std::endl;
+	}
 
 	regilo::ScanData data = controller->getScan(fromDevice);
 	std::cout << "Scan data:" << std::endl << data << std::endl;
@@ -151,6 +160,8 @@ void printHelp()
 			  << std::endl
 			  << "Options:" << std::endl
 			  << "  -l <file>     The path to the output log file." << std::endl
+			  << "  -c <dir>      The directory where the Hokuyo geometry is cached (not cached" << std::endl
+			  << "                by default)." << std::endl
 			  << "  -h, --help    Show this help." << std::endl
 			  << std::endl
 			  << "Using regilo-" << regilo::Version::VERSION << std::endl;
@@ -164,6 +175,7 @@ void parseArgs(int argc, char **argv, Arguments& args)
 		std::string arg(argv[i]);
 
 		if(arg == "-l") args.logPath = std::string(argv[++i]);
+		else if(arg == "-c") args.cacheDirectory = std::string(argv[++i]);
 		else if(arg == "-h" || arg == "--help")
 		{
 			args.help = true;
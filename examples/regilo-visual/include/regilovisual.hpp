@@ -31,6 +31,9 @@
 	#include <wx/wx.h>
 #endif
 
+#include <regilo/cartesian.hpp>
+#include <regilo/commandscheduler.hpp>
+#include <regilo/neatocontroller.hpp>
 #include <regilo/scancontroller.hpp>
 #include <regilo/scandata.hpp>
 
@@ -40,7 +43,8 @@ class RegiloVisual : public wxApp
 {
 private:
 	regilo::IScanController *controller;
-	std::mutex controllerMutex;
+	regilo::CommandScheduler scheduler;
+	std::mutex dataMutex;
 
 	bool useScanner;
 	bool manualScanning;
@@ -52,6 +56,7 @@ private:
 	double zoom;
 
 	regilo::ScanData data;
+	std::vector<regilo::Point<double>> points;
 
 	std::thread scanThread;
 	bool scanThreadRunning;
@@ -72,6 +77,8 @@ private:
 
 	void stopScanThread();
 	void scanAndShow();
+	void scheduleMotor(regilo::INeatoController *neatoController, int left, int right, int speed, const std::string& status,
+					   regilo::CommandScheduler::Priority priority = regilo::CommandScheduler::Priority::Motor);
 
 	wxImage zoomImage(const wxImage& image, double zoom);
 
@@ -149,6 +149,7 @@ int RegiloVisual::OnExit()
 	stopScanThread();
 	if(scanThread.joinable()) scanThread.join();
 	if(radarThread.joinable()) radarThread.join();
+	scheduler.stop();
 
 	return wxApp::OnExit();
 }
@@ -174,69 +175,33 @@ void RegiloVisual::setMotorByKey(wxKeyEvent& keyEvent)
 		case WXK_UP:
 			if(neatoController != nullptr)
 			{
-				controllerMutex.lock();
-				setStatusText("Going up...", 0);
-
-				if(keyEvent.ControlDown()) neatoController->setMotor(500, 500, 100);
-				else neatoController->setMotor(100, 100, 50);
-
-				setStatusText("Going up... Done!", 0);
-				controllerMutex.unlock();
+				if(keyEvent.ControlDown()) scheduleMotor(neatoController, 500, 500, 100, "Going up");
+				else scheduleMotor(neatoController, 100, 100, 50, "Going up");
 			}
 			break;
 
 		case WXK_DOWN:
-			if(neatoController != nullptr)
-			{
-				controllerMutex.lock();
-				setStatusText("Going down...", 0);
-
-				neatoController->setMotor(-100, -100, 50);
-
-				setStatusText("Going down... Done!", 0);
-				controllerMutex.unlock();
-			}
+			if(neatoController != nullptr) scheduleMotor(neatoController, -100, -100, 50, "Going down");
 			break;
 
 		case WXK_LEFT:
 			if(neatoController != nullptr)
 			{
-				controllerMutex.lock();
-				setStatusText("Turning left...", 0);
-
-				if(keyEvent.ControlDown()) neatoController->setMotor(-30, 30, 50);
-				else neatoController->setMotor(20, 100, 50);
-
-				setStatusText("Turning left... Done!", 0);
-				controllerMutex.unlock();
+				if(keyEvent.ControlDown()) scheduleMotor(neatoController, -30, 30, 50, "Turning left");
+				else scheduleMotor(neatoController, 20, 100, 50, "Turning left");
 			}
 			break;
 
 		case WXK_RIGHT:
 			if(neatoController != nullptr)
 			{
-				controllerMutex.lock();
-				setStatusText("Turning right...", 0);
-
-				if(keyEvent.ControlDown()) neatoController->setMotor(30, -30, 50);
-				else neatoController->setMotor(100, 20, 50);
-
-				setStatusText("Turning right... Done!", 0);
-				controllerMutex.unlock();
+				if(keyEvent.ControlDown()) scheduleMotor(neatoController, 30, -30, 50, "Turning right");
+				else scheduleMotor(neatoController, 100, 20, 50, "Turning right");
 			}
 			break;
 
 		case WXK_SPACE:
-			if(neatoController != nullptr)
-			{
-				controllerMutex.lock();
-				setStatusText("Stopping...", 0);
-
-				neatoController->setMotor(0, 0, 0);
-
-				setStatusText("Stopping... Done!", 0);
-				controllerMutex.unlock();
-			}
+			if(neatoController != nullptr) scheduleMotor(neatoController, 0, 0, 0, "Stopping", regilo::CommandScheduler::Priority::Safety);
 			break;
 
 		case 'S':
@@ -359,21 +324,18 @@ void RegiloVisual::repaint(wxPaintEvent&)
 
 	radarMutex.unlock();
 
-	controllerMutex.lock();
+	dataMutex.lock();
 
 	dc.SetPen(*wxThePenList->FindOrCreatePen(pointColor));
-	for(const regilo::ScanRecord& record : data)
+	for(const regilo::Point<double>& point : points)
 	{
-		if(record.error) continue;
-
-		double distance = record.distance * zoom;
-		int x = int(width2 + distance * std::cos(record.angle));
-		int y = int(height2 - distance * std::sin(record.angle));
+		int x = int(width2 + point.x * zoom);
+		int y = int(height2 - point.y * zoom);
 
 		dc.DrawRectangle(x, y, 2, 2);
 	}
 
-	controllerMutex.unlock();
+	dataMutex.unlock();
 }
 
 void RegiloVisual::stopScanThread()
@@ -388,13 +350,19 @@ void RegiloVisual::stopScanThread()
 
 void RegiloVisual::scanAndShow()
 {
-	controllerMutex.lock();
+	// Motor commands that arrive meanwhile are sent before the scan
+	scheduler.schedule(regilo::CommandScheduler::Priority::Scan, [this] ()
+	{
+		controller->getScan(data, useScanner);
+	}).get();
 
-	data = controller->getScan(useScanner);
+	dataMutex.lock();
+
+	regilo::toCartesian(data, points);
 	bool emptyData = data.empty();
 	if(emptyData) stopScanThread();
 
-	controllerMutex.unlock();
+	dataMutex.unlock();
 
 	this->GetTopWindow()->GetEventHandler()->CallAfter([this, emptyData] ()
 	{
@@ -403,6 +371,23 @@ void RegiloVisual::scanAndShow()
 	});
 }
 
+void RegiloVisual::scheduleMotor(regilo::INeatoController *neatoController, int left, int right, int speed, const std::string& status,
+								 regilo::CommandScheduler::Priority priority)
+{
+	setStatusText(status + "...", 0);
+
+	// Key repeats only need the latest motor command, the waiting ones are superseded (also by a safety stop)
+	scheduler.scheduleLatest(priority, "motor", [this, neatoController, left, right, speed, status] ()
+	{
+		neatoController->setMotor(left, right, speed);
+
+		this->GetTopWindow()->GetEventHandler()->CallAfter([this, status] ()
+		{
+			setStatusText(status + "... Done!", 0);
+		});
+	});
+}
+
 void RegiloVisual::setStatusText(const std::string& text, int i)
 {
 	frame->SetStatusText(text, i);
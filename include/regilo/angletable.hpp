@@ -0,0 +1,73 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_ANGLETABLE_HPP
+#define REGILO_ANGLETABLE_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace regilo {
+
+/**
+ * @brief The AngleTable class stores precomputed angles of scan records with their cosines and sines.
+ *
+ * The table is indexed by the record id, so the i-th values belong to the record with id i.
+ * The angle of the i-th record is (firstStep + i * stepIncrement) * resolution + startAngle.
+ */
+class AngleTable
+{
+public:
+	std::vector<double> angles; ///< The angles (in radians).
+	std::vector<double> cosines; ///< The cosines of the angles.
+	std::vector<double> sines; ///< The sines of the angles.
+
+	/**
+	 * @brief Default constructor (an empty table).
+	 */
+	AngleTable() = default;
+
+	/**
+	 * @brief Construct and compute the table.
+	 * @param firstStep The step of the first record.
+	 * @param size The number of records.
+	 * @param stepIncrement The number of steps between two records.
+	 * @param resolution The angle of one step (in radians).
+	 * @param startAngle The angle of the step zero (in radians).
+	 */
+	AngleTable(std::size_t firstStep, std::size_t size, std::size_t stepIncrement, double resolution, double startAngle);
+
+	/**
+	 * @brief Get the number of records in the table.
+	 * @return The table size.
+	 */
+	inline std::size_t size() const { return angles.size(); }
+
+	/**
+	 * @brief Test if the table is empty.
+	 * @return True if the table has no records.
+	 */
+	inline bool empty() const { return angles.empty(); }
+};
+
+}
+
+#endif // REGILO_ANGLETABLE_HPP
@@ -0,0 +1,147 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_CARTESIAN_HPP
+#define REGILO_CARTESIAN_HPP
+
+#include <vector>
+
+#include "odometry.hpp"
+#include "pose.hpp"
+#include "scandata.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The Point class represents a point in the Cartesian coordinates.
+ */
+template<typename T>
+class Point
+{
+public:
+	T x; ///< The x coordinate (in millimeters).
+	T y; ///< The y coordinate (in millimeters).
+
+	/**
+	 * @brief Default constructor.
+	 */
+	Point() = default;
+
+	/**
+	 * @brief Construct a Point from its coordinates.
+	 * @param x The x coordinate (in millimeters).
+	 * @param y The y coordinate (in millimeters).
+	 */
+	Point(T x, T y) : x(x), y(y) {}
+};
+
+/**
+ * @brief The PolarArrays struct points to the structure-of-arrays input of transformPolar().
+ */
+struct PolarArrays
+{
+	const double *distances; ///< The distances (in millimeters).
+	const double *cosines; ///< The cosines of the record angles.
+	const double *sines; ///< The sines of the record angles.
+	const double *poseX; ///< The x coordinates of the sensor poses (in millimeters).
+	const double *poseY; ///< The y coordinates of the sensor poses (in millimeters).
+	const double *poseCos; ///< The cosines of the sensor headings.
+	const double *poseSin; ///< The sines of the sensor headings.
+};
+
+/**
+ * @brief Transform polar coordinates by sensor poses to the Cartesian coordinates (the kernel of toCartesian()).
+ *
+ * The arrays are processed by AVX (four values at once) if the library is built for a CPU with it
+ * (e.g. with the native option), by SSE2 (two values) on other x86-64 CPUs or by the scalar code otherwise.
+ *
+ * @param input The input arrays (all of them with the size).
+ * @param size The number of values.
+ * @param x Output for the x coordinates.
+ * @param y Output for the y coordinates.
+ * @param vectorized False for the scalar code only (e.g. to compare the results).
+ */
+void transformPolar(const PolarArrays& input, std::size_t size, double *x, double *y, bool vectorized = true);
+
+/**
+ * @brief Convert scan records to points in the Cartesian coordinates.
+ *
+ * Records with an error are skipped. The conversion uses the precomputed ScanData::angleTable,
+ * scans without the table compute the cosine and sine of every record. The records are gathered into blocks
+ * that are transformed by transformPolar() (AVX or SSE2) and the records with an error are removed in a separate pass.
+ *
+ * @param data The scan data.
+ * @param points Output for the points (they are replaced, the capacity is reused).
+ * @param pose The sensor pose that the points are transformed by. Default: the origin.
+ * @return The number of points.
+ */
+std::size_t toCartesian(const ScanData& data, std::vector<Point<float>>& points, const Pose& pose = Pose());
+
+/**
+ * @brief Convert scan records to points in the Cartesian coordinates (a double variant).
+ * @see toCartesian(const ScanData&, std::vector<Point<float>>&, const Pose&)
+ */
+std::size_t toCartesian(const ScanData& data, std::vector<Point<double>>& points, const Pose& pose = Pose());
+
+/**
+ * @brief Convert scan records to points and remove the skew that is caused by the motion during the scan.
+ *
+ * The sensor pose moves linearly from startPose (at the first record) to endPose (at the last record),
+ * so every record is transformed by the pose at its capture time (see ScanData::getRecordTime()).
+ * The points are in the frame of the poses. Records with an error are skipped. Like the conversion
+ * without motion, it uses the precomputed ScanData::angleTable.
+ *
+ * @param data The scan data.
+ * @param points Output for the points (they are replaced, the capacity is reused).
+ * @param startPose The sensor pose at the first record.
+ * @param endPose The sensor pose at the last record.
+ * @return The number of points.
+ */
+std::size_t toCartesian(const ScanData& data, std::vector<Point<float>>& points, const Pose& startPose, const Pose& endPose);
+
+/**
+ * @brief Convert scan records to points and remove the motion skew (a double variant).
+ * @see toCartesian(const ScanData&, std::vector<Point<float>>&, const Pose&, const Pose&)
+ */
+std::size_t toCartesian(const ScanData& data, std::vector<Point<double>>& points, const Pose& startPose, const Pose& endPose);
+
+/**
+ * @brief Get the sensor poses at the first and the last record from the odometry.
+ * @param data The scan data.
+ * @param odometry The odometry.
+ * @param startPose Output for the pose at the first record.
+ * @param endPose Output for the pose at the last record.
+ * @return False if the scan time is not covered by the odometry history.
+ */
+bool getScanMotion(const ScanData& data, const Odometry& odometry, Pose& startPose, Pose& endPose);
+
+/**
+ * @brief Get the sensor pose at the first record with the constant velocity model.
+ * @param data The scan data.
+ * @param endPose The pose at the last record.
+ * @param velocity The velocity in the frame of the pose (x and y in millimeters per second, theta in radians per second).
+ * @return The pose at the first record.
+ */
+Pose getScanStartPose(const ScanData& data, const Pose& endPose, const Pose& velocity);
+
+}
+
+#endif // REGILO_CARTESIAN_HPP
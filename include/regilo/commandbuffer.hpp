@@ -0,0 +1,124 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_COMMANDBUFFER_HPP
+#define REGILO_COMMANDBUFFER_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace regilo {
+
+/**
+ * @brief The CommandBuffer class stores a serialized command in a fixed-size buffer (no heap is used).
+ */
+class CommandBuffer
+{
+public:
+	static const std::size_t CAPACITY = 64; ///< The maximum length of a command.
+
+private:
+	char buffer[CAPACITY];
+	std::size_t length = 0;
+
+	void reserve(std::size_t count);
+
+public:
+	/**
+	 * @brief Default constructor (an empty command).
+	 */
+	CommandBuffer() = default;
+
+	/**
+	 * @brief Construct a command from a string.
+	 * @param command The command.
+	 */
+	CommandBuffer(const std::string& command);
+
+	/**
+	 * @brief Get the serialized command.
+	 * @return The pointer to the first character (it is not null-terminated).
+	 */
+	inline const char* data() const { return buffer; }
+
+	/**
+	 * @brief Get the length of the command.
+	 * @return The number of characters.
+	 */
+	inline std::size_t size() const { return length; }
+
+	/**
+	 * @brief Test if the command is empty.
+	 * @return True if there are no characters.
+	 */
+	inline bool empty() const { return length == 0; }
+
+	/**
+	 * @brief Remove all characters.
+	 */
+	inline void clear() { length = 0; }
+
+	/**
+	 * @brief Append a character.
+	 * @param c The character.
+	 * @throw std::length_error If the command does not fit into the buffer.
+	 */
+	void append(char c);
+
+	/**
+	 * @brief Append characters.
+	 * @param text The characters.
+	 * @param count The number of characters.
+	 * @throw std::length_error If the command does not fit into the buffer.
+	 */
+	void append(const char *text, std::size_t count);
+
+	/**
+	 * @brief Append a string.
+	 * @param text The string.
+	 * @throw std::length_error If the command does not fit into the buffer.
+	 */
+	void append(const std::string& text);
+
+	/**
+	 * @brief Append an integer in the decimal notation.
+	 * @param value The integer.
+	 * @param width The minimal number of digits (zeros are prepended).
+	 * @throw std::length_error If the command does not fit into the buffer.
+	 */
+	void append(long value, std::size_t width);
+
+	/**
+	 * @brief Get the command as a string.
+	 * @return The command.
+	 */
+	inline std::string str() const { return std::string(buffer, length); }
+
+	/**
+	 * @brief Output the command.
+	 */
+	friend std::ostream& operator<<(std::ostream& out, const CommandBuffer& command);
+};
+
+}
+
+#endif // REGILO_COMMANDBUFFER_HPP
@@ -0,0 +1,138 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_COMMANDDESCRIPTOR_HPP
+#define REGILO_COMMANDDESCRIPTOR_HPP
+
+#include <string>
+
+#include "commandbuffer.hpp"
+
+namespace regilo {
+
+namespace command {
+
+/**
+ * @brief An integer parameter of a command.
+ * @tparam Width The minimal number of digits (zeros are prepended), zero for no padding.
+ */
+template<std::size_t Width = 0>
+struct Int
+{
+	typedef long Type; ///< The type of the parameter value.
+
+	/**
+	 * @brief Serialize the value into the buffer.
+	 */
+	static inline void write(CommandBuffer& buffer, Type value) { buffer.append(value, Width); }
+};
+
+/**
+ * @brief A text parameter of a command.
+ */
+struct Text
+{
+	typedef std::string Type; ///< The type of the parameter value.
+
+	/**
+	 * @brief Serialize the value into the buffer.
+	 */
+	static inline void write(CommandBuffer& buffer, const Type& value) { buffer.append(value); }
+};
+
+}
+
+/**
+ * @brief The CommandDescriptor class describes a command with typed parameters.
+ *
+ * The descriptor is a compile-time constant and it serializes the parameters directly into a CommandBuffer.
+ *
+ * @tparam Separator A char that is put before every parameter or '\0' for no separator.
+ * @tparam Fields The types of the parameters (command::Int or command::Text).
+ */
+template<char Separator, typename... Fields>
+class CommandDescriptor
+{
+private:
+	const char *name;
+
+	template<typename Field>
+	static void writeField(CommandBuffer& buffer, const typename Field::Type& value);
+
+public:
+	/**
+	 * @brief Construct a descriptor.
+	 * @param name The command name.
+	 */
+	constexpr explicit CommandDescriptor(const char *name) : name(name) {}
+
+	/**
+	 * @brief Get the command name.
+	 * @return The name.
+	 */
+	constexpr const char* getName() const { return name; }
+
+	/**
+	 * @brief Serialize the command with the parameters into a buffer.
+	 * @param buffer The output buffer (it is cleared at first).
+	 * @param values The parameters.
+	 * @throw std::length_error If the command does not fit into the buffer.
+	 */
+	void serialize(CommandBuffer& buffer, const typename Fields::Type& ... values) const;
+
+	/**
+	 * @brief Create the command with the parameters.
+	 * @param values The parameters.
+	 * @return The serialized command.
+	 */
+	CommandBuffer operator()(const typename Fields::Type& ... values) const;
+};
+
+template<char Separator, typename... Fields>
+template<typename Field>
+void CommandDescriptor<Separator, Fields...>::writeField(CommandBuffer& buffer, const typename Field::Type& value)
+{
+	if(Separator != '\0') buffer.append(Separator);
+	Field::write(buffer, value);
+}
+
+template<char Separator, typename... Fields>
+void CommandDescriptor<Separator, Fields...>::serialize(CommandBuffer& buffer, const typename Fields::Type& ... values) const
+{
+	buffer.clear();
+	buffer.append(name, std::char_traits<char>::length(name));
+
+	int expand[] = { 0, (writeField<Fields>(buffer, values), 0)... };
+	(void) expand;
+}
+
+template<char Separator, typename... Fields>
+CommandBuffer CommandDescriptor<Separator, Fields...>::operator()(const typename Fields::Type& ... values) const
+{
+	CommandBuffer buffer;
+	serialize(buffer, values...);
+
+	return buffer;
+}
+
+}
+
+#endif // REGILO_COMMANDDESCRIPTOR_HPP
@@ -0,0 +1,238 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_COMMANDSCHEDULER_HPP
+#define REGILO_COMMANDSCHEDULER_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace regilo {
+
+/**
+ * @brief The CommandScheduler class runs the commands of one controller in the order of their priorities.
+ *
+ * The commands are executed one by one on a worker thread, so a higher-priority command waits only for
+ * the command that is already in flight (e.g. a `setmotor` goes right after the current scan, before
+ * the queued scans and telemetry). A waiting command is promoted by one priority level for every
+ * agingInterval, so lower priorities cannot starve. Periodic commands (e.g. the telemetry polls between
+ * the scans) are queued by the worker itself whenever they are due.
+ */
+class CommandScheduler
+{
+public:
+	/**
+	 * @brief The priority of a command (Safety is the highest).
+	 */
+	enum class Priority
+	{
+		Safety,
+		Motor,
+		Scan,
+		Telemetry
+	};
+
+	static const std::size_t PRIORITY_COUNT = 4; ///< The number of priority levels.
+
+	/**
+	 * @brief The Stats struct contains the queue metrics of a scheduler.
+	 */
+	struct Stats
+	{
+		std::array<std::size_t, PRIORITY_COUNT> depth {}; ///< The current number of waiting commands per priority.
+		std::array<std::size_t, PRIORITY_COUNT> maxDepth {}; ///< The maximum number of waiting commands per priority.
+		std::array<std::size_t, PRIORITY_COUNT> executed {}; ///< The number of executed commands per priority.
+		std::size_t promoted = 0; ///< The number of commands that were executed thanks to aging.
+		std::size_t replaced = 0; ///< The number of waiting commands that were replaced by a newer one.
+		std::size_t skipped = 0; ///< The number of periodic runs that were skipped because the previous one still waited.
+		std::size_t failed = 0; ///< The number of periodic runs that threw an exception.
+		std::chrono::microseconds maxWait = std::chrono::microseconds::zero(); ///< The longest time a command waited in the queue.
+	};
+
+private:
+	struct Job
+	{
+		std::function<void()> task;
+		std::chrono::steady_clock::time_point queued;
+		std::uint64_t sequence;
+		std::string key;
+		std::size_t periodicId;
+	};
+
+	struct Periodic
+	{
+		std::size_t id;
+		std::size_t level;
+		std::chrono::steady_clock::duration period;
+		std::function<void()> task;
+		std::chrono::steady_clock::time_point due;
+	};
+
+	std::chrono::steady_clock::duration agingInterval;
+
+	std::array<std::deque<Job>, PRIORITY_COUNT> queues;
+	std::uint64_t nextSequence = 0;
+	std::vector<Periodic> periodics;
+	std::size_t nextPeriodicId = 1;
+	Stats stats;
+
+	mutable std::mutex mutex;
+	std::condition_variable condition;
+	bool running = true;
+	std::thread worker;
+
+	void enqueue(Priority priority, std::function<void()>&& task, const std::string& key);
+	std::chrono::steady_clock::time_point queuePeriodic(std::chrono::steady_clock::time_point now);
+	bool hasJobs() const;
+	std::size_t selectQueue(std::chrono::steady_clock::time_point now, bool& promoted) const;
+	void run();
+
+public:
+	/**
+	 * @brief Start the worker thread.
+	 * @param agingInterval The waiting time after which a command is promoted by one priority level (zero disables aging).
+	 */
+	CommandScheduler(std::chrono::milliseconds agingInterval = std::chrono::milliseconds(500));
+
+	/**
+	 * @brief Stop the worker thread (see stop()).
+	 */
+	~CommandScheduler();
+
+	CommandScheduler(const CommandScheduler&) = delete;
+	CommandScheduler& operator=(const CommandScheduler&) = delete;
+
+	/**
+	 * @brief Queue a command.
+	 * @param priority The priority of the command.
+	 * @param command A function that sends the command (e.g. a lambda that calls a controller method).
+	 * @return A future with the result of the function (or its exception).
+	 */
+	template<typename Function>
+	std::future<typename std::result_of<Function()>::type> schedule(Priority priority, Function command);
+
+	/**
+	 * @brief Queue a command that supersedes the waiting commands with the same key and the same or a lower priority.
+	 *
+	 * This is meant for commands where only the latest value matters (e.g. motor commands from a key repeat).
+	 * A command with a higher priority also supersedes the lower ones (e.g. a safety stop drops the waiting motor
+	 * commands), but a command never supersedes a waiting one with a higher priority.
+	 * The futures of the replaced commands throw std::future_error (broken promise).
+	 *
+	 * @param priority The priority of the command.
+	 * @param key The key of the commands that replace each other (it cannot be empty).
+	 * @param command A function that sends the command (e.g. a lambda that calls a controller method).
+	 * @return A future with the result of the function (or its exception).
+	 * @throw std::invalid_argument If the key is empty.
+	 */
+	template<typename Function>
+	std::future<typename std::result_of<Function()>::type> scheduleLatest(Priority priority, const std::string& key, Function command);
+
+	/**
+	 * @brief Run a command repeatedly.
+	 *
+	 * The command is queued with the priority whenever its period elapses, the first time right away.
+	 * At most one run of it waits in the queue, so a busy link skips the runs instead of piling them up.
+	 * The exceptions of the command are only counted (see Stats::failed). E.g. the Neato wheel positions
+	 * are polled between the scans by `schedulePeriodic(Priority::Telemetry, period, [&] () { controller.pollTelemetry(); })`.
+	 *
+	 * @param priority The priority of the command.
+	 * @param period The period (it has to be positive).
+	 * @param command A function that sends the command.
+	 * @return An id of the periodic command (see cancelPeriodic()).
+	 * @throw std::invalid_argument If the period is not positive.
+	 */
+	std::size_t schedulePeriodic(Priority priority, std::chrono::milliseconds period, std::function<void()> command);
+
+	/**
+	 * @brief Stop running a periodic command.
+	 *
+	 * Its waiting run is discarded, but the run in flight is finished.
+	 *
+	 * @param id The id returned by schedulePeriodic().
+	 * @return False if there is no such periodic command.
+	 */
+	bool cancelPeriodic(std::size_t id);
+
+	/**
+	 * @brief Get the number of waiting commands.
+	 * @return The number of commands in all queues.
+	 */
+	std::size_t getQueueDepth() const;
+
+	/**
+	 * @brief Get the queue metrics.
+	 * @return A copy of the current stats.
+	 */
+	Stats getStats() const;
+
+	/**
+	 * @brief Finish the command in flight and stop the worker thread.
+	 *
+	 * The waiting and periodic commands are discarded and the futures throw std::future_error (broken promise).
+	 */
+	void stop();
+};
+
+template<typename Function>
+std::future<typename std::result_of<Function()>::type> CommandScheduler::schedule(Priority priority, Function command)
+{
+	typedef typename std::result_of<Function()>::type Result;
+
+	// std::function needs a copyable target, so the task is shared
+	std::shared_ptr<std::packaged_task<Result()>> task = std::make_shared<std::packaged_task<Result()>>(std::move(command));
+	std::future<Result> result = task->get_future();
+
+	enqueue(priority, [task] () { (*task)(); }, std::string());
+
+	return result;
+}
+
+template<typename Function>
+std::future<typename std::result_of<Function()>::type> CommandScheduler::scheduleLatest(Priority priority, const std::string& key, Function command)
+{
+	if(key.empty()) throw std::invalid_argument("The key cannot be empty.");
+
+	typedef typename std::result_of<Function()>::type Result;
+
+	std::shared_ptr<std::packaged_task<Result()>> task = std::make_shared<std::packaged_task<Result()>>(std::move(command));
+	std::future<Result> result = task->get_future();
+
+	enqueue(priority, [task] () { (*task)(); }, key);
+
+	return result;
+}
+
+}
+
+#endif // REGILO_COMMANDSCHEDULER_HPP
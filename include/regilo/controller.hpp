@@ -22,14 +22,28 @@
 #ifndef REGILO_CONTROLLER_HPP
 #define REGILO_CONTROLLER_HPP
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/asio/streambuf.hpp>
 #include <boost/asio/write.hpp>
 
+#include "commanddescriptor.hpp"
+#include "delimitermatcher.hpp"
 #include "log.hpp"
+#include "reconnectpolicy.hpp"
+#include "timeouterror.hpp"
 #include "utils.hpp"
 
 namespace regilo {
@@ -99,20 +113,150 @@ class StreamController : public virtual IController
 {
 private:
 	ba::streambuf istreamBuffer;
-	std::istream istream;
+	DelimiterMatcher requestEndMatcher;
+	DelimiterMatcher responseEndMatcher;
 
-	ba::streambuf ostreamBuffer;
-	std::ostream ostream;
+	// A non-owning buffer sequence (ba::write copies the sequence, so a std::vector would be copied on every write)
+	struct BufferRange
+	{
+		typedef ba::const_buffer value_type;
+		typedef const ba::const_buffer* const_iterator;
+
+		const_iterator first;
+		const_iterator last;
+
+		inline const_iterator begin() const { return first; }
+		inline const_iterator end() const { return last; }
+	};
+
+	std::vector<ba::const_buffer> writeBuffers;
+
+	// Wakes up a blocked caller when its operation finishes on a shared io_service
+	struct Waiter
+	{
+		std::mutex mutex;
+		std::condition_variable condition;
+	};
+
+	// A completion handler that stores the result of an asynchronous operation
+	struct Completion
+	{
+		boost::system::error_code *error;
+		std::size_t *size;
+		Waiter *waiter;
+
+		inline void operator()(const boost::system::error_code& error, std::size_t size) const
+		{
+			if(waiter == nullptr)
+			{
+				*this->error = error;
+				*this->size = size;
+			}
+			else
+			{
+				std::lock_guard<std::mutex> lock(waiter->mutex);
+				*this->error = error;
+				*this->size = size;
+				waiter->condition.notify_one();
+			}
+		}
+	};
+
+	// A composed operation that sends a command and reads its response without blocking
+	template<typename Consumer, typename Handler>
+	struct AsyncCommand
+	{
+		enum class Step { Write, Echo, Response };
+
+		StreamController *controller;
+		const CommandBuffer *command;
+		Consumer consume;
+		Handler handler;
+		std::shared_ptr<std::string> output;
+		Step step;
+		std::size_t searched;
+
+		void operator()(const boost::system::error_code& error, std::size_t size);
+		void finish(const boost::system::error_code& error);
+	};
+
+	std::size_t asyncCommandId = 0;
+	bool asyncExpired = false;
+
+	std::chrono::steady_clock::time_point deadline;
+	bool hasDeadline = false;
+	bool resynchronize = false;
+
+	ConnectionStats connectionStats;
+	bool reconnecting = false;
+
+	void beginCommand(std::chrono::milliseconds timeout);
+
+	template<typename Operation>
+	std::size_t runUntilDeadline(Operation&& operation);
+
+	template<typename ConstBufferSequence>
+	void write(const ConstBufferSequence& buffers);
+
+	std::size_t readSome();
+	std::size_t readUntilCondition(const DelimiterMatcher::Condition& condition);
+
+	void discardPending();
+
+	template<typename Consumer>
+	bool consumeUntil(DelimiterMatcher& matcher, Consumer& consume, std::size_t& searched);
+
+	template<typename Consumer>
+	void readUntil(DelimiterMatcher& matcher, Consumer& consume);
+
+	void writeCommands(const CommandBuffer *commands, std::size_t count);
+
+	template<typename Consumer>
+	void receive(Consumer& consume, std::string *output);
+
+	void writeLog(const char *command, std::size_t size, const std::string& output);
+
+	void exchange(const char *command, std::size_t size, std::chrono::milliseconds timeout);
+
+	template<typename Response, typename std::enable_if<std::is_void<Response>::value>::type* = nullptr>
+	void outputAs();
+
+	template<typename Response, typename std::enable_if<!std::is_void<Response>::value>::type* = nullptr>
+	Response outputAs();
 
 protected:
 	std::istringstream deviceOutput; ///< A buffer for the device output.
 	std::ostringstream deviceInput; ///< A buffer for the device input.
 
-	ba::io_service ioService; ///< The Boost IO service.
+	std::unique_ptr<ba::io_service> ownIoService; ///< The IO service that is owned by the controller (empty if it is shared).
+	ba::io_service& ioService; ///< The Boost IO service.
 	StreamT stream; ///< A stream (TCP, socket, etc.) that is used for read/write operations.
+	ba::steady_timer deadlineTimer; ///< A timer that cancels the stream operations when the command deadline expires.
+	ba::io_service::strand strand; ///< A strand that serializes the asynchronous handlers of this controller.
 
 	std::shared_ptr<Log> log; ///< A log that is connected to the controller.
 
+	/**
+	 * @brief Close the stream and open it again with the last connected endpoint.
+	 */
+	virtual void reopen() = 0;
+
+	/**
+	 * @brief Restore the known device state after a reconnect (e.g. turn on the modes that were on).
+	 */
+	virtual void resume() {}
+
+	/**
+	 * @brief Call a function and if it fails because the connection is lost, reconnect and call it once again.
+	 *
+	 * The function has to be repeatable (it is called from the beginning after the reconnect).
+	 * Timeouts are not treated as a lost connection.
+	 *
+	 * @param function The function with the whole command.
+	 */
+	template<typename Function>
+	void retryOnDisconnect(Function&& function);
+
 	/**
 	 * @brief Send a command from the device input to the device.
 	 */
@@ -126,6 +270,66 @@ protected:
 	template<typename Response, typename std::enable_if<!std::is_void<Response>::value>::type* = nullptr>
 	Response sendCommand();
 
+	/**
+	 * @brief Send a command to the device and pass the response to a consumer as it arrives.
+	 *
+	 * The consumer is called with every received part of the response (without the command and RESPONSE_END)
+	 * as `consume(const char *begin, const char *end)`, so the response can be processed before it is complete.
+	 *
+	 * @param command The command.
+	 * @param consume The consumer of the response parts.
+	 */
+	template<typename Consumer>
+	void sendCommandStreamed(const CommandBuffer& command, Consumer&& consume);
+
+	/**
+	 * @brief Send a command to the device and pass the response to a consumer as it arrives.
+	 * @param command The command.
+	 * @param timeout The maximum duration of the whole command (zero means no deadline).
+	 * @param consume The consumer of the response parts.
+	 */
+	template<typename Consumer>
+	void sendCommandStreamed(const CommandBuffer& command, std::chrono::milliseconds timeout, Consumer&& consume);
+
+	/**
+	 * @brief Send more commands to the device in a single write and pass their responses to a consumer as they arrive.
+	 *
+	 * The consumer is called as `consume(std::size_t index, const char *begin, const char *end)`
+	 * where index is the position of the command that the response part belongs to.
+	 * The commands are not repeated after a lost connection (see retryOnDisconnect).
+	 *
+	 * @param commands The commands.
+	 * @param count The number of commands.
+	 * @param consume The consumer of the response parts.
+	 */
+	template<typename Consumer>
+	void sendCommandsStreamed(const CommandBuffer *commands, std::size_t count, Consumer&& consume);
+
+	/**
+	 * @brief Send more commands to the device in a single write and pass their responses to a consumer as they arrive.
+	 * @param commands The commands.
+	 * @param count The number of commands.
+	 * @param timeout The maximum duration of all the commands together (zero means no deadline).
+	 * @param consume The consumer of the response parts.
+	 */
+	template<typename Consumer>
+	void sendCommandsStreamed(const CommandBuffer *commands, std::size_t count, std::chrono::milliseconds timeout, Consumer&& consume);
+
+	/**
+	 * @brief Send a command to the device without blocking and pass the response to a consumer as it arrives.
+	 *
+	 * The handler is called as `handler(const boost::system::error_code& error)` after the whole response
+	 * is received. The consumer and the handler are called through the strand from a thread that runs the io_service
+	 * (see ControllerManager). The command has to be valid and no other command can be sent until the handler is called.
+	 * The default timeout is used, but the command is not repeated after a lost connection.
+	 *
+	 * @param command The command.
+	 * @param consume The consumer of the response parts.
+	 * @param handler The completion handler.
+	 */
+	template<typename Consumer, typename Handler>
+	void asyncSendCommandStreamed(const CommandBuffer& command, Consumer consume, Handler handler);
+
 public:
 	typedef StreamT Stream; ///< The stream type for this Controller.
 
@@ -135,11 +339,29 @@ public:
 	bool readResponse = true; ///< If true the sendCommand method reads a response.
 	bool readCommand = true; ///< If true the input command is read from the response at first.
 
+	/**
+	 * @brief The default deadline of every command (zero means no deadline).
+	 *
+	 * The deadline covers the whole command (writing, reading the echo and the response). When it expires,
+	 * the pending operation is canceled, the partial response is discarded and TimeoutError is thrown.
+	 */
+	std::chrono::milliseconds timeout = std::chrono::milliseconds::zero();
+
+	ReconnectPolicy reconnectPolicy; ///< The policy of the automatic reconnect (disabled by default).
+
+	static const std::size_t READ_SIZE = 4096; ///< The maximum number of bytes that are read from the stream at once.
+
 	/**
 	 * @brief Default constructor.
 	 */
 	StreamController();
 
+	/**
+	 * @brief Controller that uses a shared IO service (e.g. from ControllerManager).
+	 * @param ioService The IO service that has to outlive the controller.
+	 */
+	StreamController(ba::io_service& ioService);
+
 	/**
 	 * @brief Controller with a log file specified by a path.
 	 * @param logPath Path to the log file.
@@ -159,11 +381,32 @@ public:
 
 	virtual inline bool isConnected() const override { return stream.is_open(); }
 
+	/**
+	 * @brief Get the IO service that the controller uses.
+	 * @return The IO service.
+	 */
+	inline ba::io_service& getIoService() { return ioService; }
+
 	virtual inline std::shared_ptr<ILog> getLog() override { return log; }
 	virtual inline std::shared_ptr<const ILog> getLog() const override { return log; }
 
 	virtual void setLog(std::shared_ptr<ILog> log) override;
 
+	/**
+	 * @brief Reconnect to the last connected endpoint and restore the device state.
+	 *
+	 * The attempts are delayed according to the reconnectPolicy (one attempt is made even if it is disabled).
+	 *
+	 * @return True if the controller is connected again.
+	 */
+	bool reconnect();
+
+	/**
+	 * @brief Get the reconnect metrics.
+	 * @return The connection statistics.
+	 */
+	inline const ConnectionStats& getConnectionStats() const { return connectionStats; }
+
 	virtual std::string sendCommand(const std::string& command) final override;
 
 	/**
@@ -174,6 +417,24 @@ public:
 	template<typename Response = void, typename Command>
 	Response sendCommand(const Command& command);
 
+	/**
+	 * @brief Send a serialized command to the device (it is written directly from the buffer).
+	 * @param command A command with all parameters.
+	 * @return A response to the command.
+	 */
+	template<typename Response = void>
+	Response sendCommand(const CommandBuffer& command);
+
+	/**
+	 * @brief Send a serialized command to the device with its own deadline.
+	 * @param command A command with all parameters.
+	 * @param timeout The maximum duration of the command (zero means no deadline).
+	 * @return A response to the command.
+	 * @throw TimeoutError If the command does not finish in time.
+	 */
+	template<typename Response = void>
+	Response sendCommand(const CommandBuffer& command, std::chrono::milliseconds timeout);
+
 	/**
 	 * @brief Send a command to the device.
 	 * @param command A command without parameters.
@@ -204,9 +465,20 @@ public:
 
 template<typename StreamT>
 StreamController<StreamT>::StreamController() :
-	istream(&istreamBuffer),
-	ostream(&ostreamBuffer),
-	stream(ioService)
+	ownIoService(new ba::io_service()),
+	ioService(*ownIoService),
+	stream(ioService),
+	deadlineTimer(ioService),
+	strand(ioService)
+{
+}
+
+template<typename StreamT>
+StreamController<StreamT>::StreamController(ba::io_service& ioService) :
+	ioService(ioService),
+	stream(ioService),
+	deadlineTimer(ioService),
+	strand(ioService)
 {
 }
 
@@ -238,10 +510,69 @@ void StreamController<StreamT>::setLog(std::shared_ptr<ILog> log)
 	this->log.swap(logPointer);
 }
 
+template<typename StreamT>
+bool StreamController<StreamT>::reconnect()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::size_t maxAttempts = std::max<std::size_t>(reconnectPolicy.maxAttempts, 1);
+
+	connectionStats.disconnects++;
+	reconnecting = true;
+
+	for(std::size_t attempt = 0; attempt < maxAttempts; attempt++)
+	{
+		std::this_thread::sleep_for(reconnectPolicy.getDelay(attempt));
+		connectionStats.attempts++;
+
+		try
+		{
+			istreamBuffer.consume(istreamBuffer.size());
+			resynchronize = false;
+
+			reopen();
+			resume();
+		}
+		catch(boost::system::system_error&)
+		{
+			continue;
+		}
+
+		reconnecting = false;
+
+		connectionStats.reconnects++;
+		connectionStats.lastDowntime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+		connectionStats.totalDowntime += connectionStats.lastDowntime;
+
+		return true;
+	}
+
+	reconnecting = false;
+
+	return false;
+}
+
+template<typename StreamT>
+template<typename Function>
+void StreamController<StreamT>::retryOnDisconnect(Function&& function)
+{
+	try
+	{
+		function();
+	}
+	catch(boost::system::system_error& error)
+	{
+		if(reconnecting || reconnectPolicy.maxAttempts == 0) throw;
+		if(error.code() == ba::error::timed_out || error.code() == ba::error::operation_aborted) throw;
+
+		if(!reconnect()) throw;
+		function();
+	}
+}
+
 template<typename StreamT>
 std::string StreamController<StreamT>::sendCommand(const std::string& command)
 {
-	sendCommand<>(command);
+	exchange(command.data(), command.size(), timeout);
 
 	std::string response;
 	std::getline(deviceOutput, response, '\0');
@@ -257,6 +588,21 @@ Response StreamController<StreamT>::sendCommand(const Command& command)
 	return sendCommand<Response>();
 }
 
+template<typename StreamT>
+template<typename Response>
+Response StreamController<StreamT>::sendCommand(const CommandBuffer& command)
+{
+	return sendCommand<Response>(command, timeout);
+}
+
+template<typename StreamT>
+template<typename Response>
+Response StreamController<StreamT>::sendCommand(const CommandBuffer& command, std::chrono::milliseconds timeout)
+{
+	exchange(command.data(), command.size(), timeout);
+	return outputAs<Response>();
+}
+
 template<typename StreamT>
 template<typename Response, typename Command, typename... Args>
 Response StreamController<StreamT>::sendCommand(const Command& command, const Args& ... params)
@@ -273,62 +619,499 @@ Response StreamController<StreamT>::sendFormattedCommand(const std::string& comm
 }
 
 template<typename StreamT>
-template<typename Response, typename std::enable_if<std::is_void<Response>::value>::type*>
-void StreamController<StreamT>::sendCommand()
+const std::size_t StreamController<StreamT>::READ_SIZE;
+
+template<typename StreamT>
+void StreamController<StreamT>::beginCommand(std::chrono::milliseconds timeout)
 {
-	deviceInput << REQUEST_END;
+	if(resynchronize)
+	{
+		discardPending();
+		resynchronize = false;
+	}
 
-	std::string input = deviceInput.str();
-	ostream << input;
+	hasDeadline = (timeout > std::chrono::milliseconds::zero());
+	if(hasDeadline) deadline = std::chrono::steady_clock::now() + timeout;
+}
 
-	ba::write(stream, ostreamBuffer);
-	ostream.flush();
+template<typename StreamT>
+template<typename Operation>
+std::size_t StreamController<StreamT>::runUntilDeadline(Operation&& operation)
+{
+	std::chrono::steady_clock::duration remaining = deadline - std::chrono::steady_clock::now();
+	bool expired = (remaining <= std::chrono::steady_clock::duration::zero());
 
-	deviceInput.clear();
-	deviceInput.str("");
+	boost::system::error_code error = ba::error::would_block;
+	std::size_t size = 0;
 
-	std::string output;
-	if(readResponse)
+	if(!expired && !ownIoService)
 	{
-		ba::read_until(stream, istreamBuffer, RESPONSE_END);
+		// The shared io_service is run by other threads, so this one only waits for the result
+		Waiter waiter;
+		std::unique_lock<std::mutex> lock(waiter.mutex);
+		operation(Completion { &error, &size, &waiter });
 
-		if(readCommand)
+		auto finished = [&error] () { return error != ba::error::would_block; };
+		if(!waiter.condition.wait_until(lock, deadline, finished))
 		{
-			std::string cmdInput;
-			getLine(istream, cmdInput, REQUEST_END);
-			cmdInput = cmdInput.substr(0, cmdInput.length() - REQUEST_END.length());
+			expired = true;
+
+			bool canceled = false;
+			strand.post([this, &waiter, &canceled] ()
+			{
+				stream.cancel();
+
+				std::lock_guard<std::mutex> lock(waiter.mutex);
+				canceled = true;
+				waiter.condition.notify_one();
+			});
+
+			waiter.condition.wait(lock, [&error, &canceled] () { return canceled && error != ba::error::would_block; });
 		}
+	}
+	else if(!expired)
+	{
+		operation(Completion { &error, &size, nullptr });
+
+		deadlineTimer.expires_from_now(remaining);
+		deadlineTimer.async_wait([this, &error, &expired] (const boost::system::error_code& timerError)
+		{
+			// The operation can finish while the expired timer waits in the queue
+			if(!timerError && error == ba::error::would_block)
+			{
+				expired = true;
+				stream.cancel();
+			}
+		});
+
+		ioService.reset();
+		while(error == ba::error::would_block) ioService.run_one();
+
+		// Let the canceled timer handler finish, so nothing refers to this frame afterwards
+		deadlineTimer.cancel();
+		ioService.run();
+	}
+
+	if(expired)
+	{
+		// The rest of the response can still arrive, so the next command discards it at first
+		istreamBuffer.consume(istreamBuffer.size());
+		resynchronize = true;
+
+		throw TimeoutError();
+	}
+
+	if(error) throw boost::system::system_error(error);
+
+	return size;
+}
 
-		getLine(istream, output, RESPONSE_END);
+template<typename StreamT>
+template<typename ConstBufferSequence>
+void StreamController<StreamT>::write(const ConstBufferSequence& buffers)
+{
+	if(!hasDeadline) ba::write(stream, buffers);
+	else
+	{
+		runUntilDeadline([this, &buffers] (const Completion& completion)
+		{
+			ba::async_write(stream, buffers, completion);
+		});
+	}
+}
+
+template<typename StreamT>
+std::size_t StreamController<StreamT>::readSome()
+{
+	if(!hasDeadline) return stream.read_some(istreamBuffer.prepare(READ_SIZE));
+
+	return runUntilDeadline([this] (const Completion& completion)
+	{
+		stream.async_read_some(istreamBuffer.prepare(READ_SIZE), completion);
+	});
+}
+
+template<typename StreamT>
+std::size_t StreamController<StreamT>::readUntilCondition(const DelimiterMatcher::Condition& condition)
+{
+	if(!hasDeadline) return ba::read_until(stream, istreamBuffer, condition);
+
+	return runUntilDeadline([this, &condition] (const Completion& completion)
+	{
+		ba::async_read_until(stream, istreamBuffer, condition, completion);
+	});
+}
+
+template<typename StreamT>
+void StreamController<StreamT>::discardPending()
+{
+	istreamBuffer.consume(istreamBuffer.size());
+
+	// The shared io_service cannot be polled from here, so only the buffered data are discarded
+	if(!ownIoService) return;
+
+	// Read everything that is already available without blocking
+	while(true)
+	{
+		boost::system::error_code error = ba::error::would_block;
+		std::size_t size = 0;
+
+		stream.async_read_some(istreamBuffer.prepare(READ_SIZE), Completion { &error, &size, nullptr });
+
+		ioService.reset();
+		ioService.poll();
+
+		if(error == ba::error::would_block)
+		{
+			stream.cancel();
+			ioService.reset();
+			ioService.run();
+		}
+
+		if(error || size == 0) break;
+	}
+}
+
+template<typename StreamT>
+template<typename Consumer>
+bool StreamController<StreamT>::consumeUntil(DelimiterMatcher& matcher, Consumer& consume, std::size_t& searched)
+{
+	const char *begin = ba::buffer_cast<const char*>(istreamBuffer.data());
+	const char *end = begin + istreamBuffer.size();
+
+	const char *found = matcher.find(begin + searched, end);
+	if(found != nullptr)
+	{
+		const char *responseEnd = found - matcher.getDelimiter().size();
+		if(responseEnd != begin) consume(begin, responseEnd);
+		istreamBuffer.consume(found - begin);
+
+		return true;
+	}
+
+	// The matched tail can be the beginning of the delimiter, so it waits for more data
+	std::size_t ready = istreamBuffer.size() - matcher.getMatchedSize();
+	if(ready != 0)
+	{
+		consume(begin, begin + ready);
+		istreamBuffer.consume(ready);
+	}
+
+	searched = istreamBuffer.size();
+
+	return false;
+}
+
+template<typename StreamT>
+template<typename Consumer>
+void StreamController<StreamT>::readUntil(DelimiterMatcher& matcher, Consumer& consume)
+{
+	if(matcher.getDelimiter().empty()) return;
+
+	matcher.reset();
+	std::size_t searched = 0;
+
+	while(!consumeUntil(matcher, consume, searched))
+	{
+		istreamBuffer.commit(readSome());
+	}
+}
+
+template<typename StreamT>
+void StreamController<StreamT>::writeCommands(const CommandBuffer *commands, std::size_t count)
+{
+	writeBuffers.clear();
+	for(std::size_t i = 0; i < count; i++)
+	{
+		writeBuffers.push_back(ba::buffer(commands[i].data(), commands[i].size()));
+		writeBuffers.push_back(ba::buffer(REQUEST_END));
+	}
+
+	write(BufferRange { writeBuffers.data(), writeBuffers.data() + writeBuffers.size() });
+}
+
+template<typename StreamT>
+template<typename Consumer>
+void StreamController<StreamT>::receive(Consumer& consume, std::string *output)
+{
+	if(!readResponse) return;
+
+	if(readCommand && !REQUEST_END.empty())
+	{
+		if(requestEndMatcher.getDelimiter() != REQUEST_END) requestEndMatcher.setDelimiter(REQUEST_END);
+		else requestEndMatcher.reset();
+
+		istreamBuffer.consume(readUntilCondition(requestEndMatcher.condition()));
+	}
+
+	if(responseEndMatcher.getDelimiter() != RESPONSE_END) responseEndMatcher.setDelimiter(RESPONSE_END);
+
+	if(output == nullptr) readUntil(responseEndMatcher, consume);
+	else
+	{
+		auto append = [&consume, output] (const char *begin, const char *end)
+		{
+			output->append(begin, end);
+			consume(begin, end);
+		};
+		readUntil(responseEndMatcher, append);
+	}
+}
+
+template<typename StreamT>
+void StreamController<StreamT>::writeLog(const char *command, std::size_t size, const std::string& output)
+{
+	if(log != nullptr) log->write(std::string(command, size) + REQUEST_END, output);
+}
+
+template<typename StreamT>
+void StreamController<StreamT>::exchange(const char *command, std::size_t size, std::chrono::milliseconds timeout)
+{
+	std::string output;
+	retryOnDisconnect([this, command, size, timeout, &output] ()
+	{
+		beginCommand(timeout);
+
+		std::array<ba::const_buffer, 2> buffers = {{ ba::buffer(command, size), ba::buffer(REQUEST_END) }};
+		write(buffers);
+
+		output.clear();
+		auto skip = [] (const char*, const char*) {};
+		receive(skip, &output);
+	});
+
+	writeLog(command, size, output);
+
+	if(readResponse)
+	{
 		deviceOutput.clear();
 		deviceOutput.str(output);
 	}
+}
 
-	if(log != nullptr) log->write(input, output);
+template<typename StreamT>
+template<typename Response, typename std::enable_if<std::is_void<Response>::value>::type*>
+void StreamController<StreamT>::outputAs()
+{
 }
 
 template<typename StreamT>
 template<typename Response, typename std::enable_if<!std::is_void<Response>::value>::type*>
-Response StreamController<StreamT>::sendCommand()
+Response StreamController<StreamT>::outputAs()
 {
-	sendCommand();
-
 	Response output;
 	deviceOutput >> output;
 
 	return output;
 }
 
+template<typename StreamT>
+template<typename Consumer>
+void StreamController<StreamT>::sendCommandStreamed(const CommandBuffer& command, Consumer&& consume)
+{
+	sendCommandStreamed(command, timeout, std::forward<Consumer>(consume));
+}
+
+template<typename StreamT>
+template<typename Consumer>
+void StreamController<StreamT>::sendCommandStreamed(const CommandBuffer& command, std::chrono::milliseconds timeout, Consumer&& consume)
+{
+	sendCommandsStreamed(&command, 1, timeout, [&consume] (std::size_t, const char *begin, const char *end)
+	{
+		consume(begin, end);
+	});
+}
+
+template<typename StreamT>
+template<typename Consumer>
+void StreamController<StreamT>::sendCommandsStreamed(const CommandBuffer *commands, std::size_t count, Consumer&& consume)
+{
+	sendCommandsStreamed(commands, count, timeout, std::forward<Consumer>(consume));
+}
+
+template<typename StreamT>
+template<typename Consumer>
+void StreamController<StreamT>::sendCommandsStreamed(const CommandBuffer *commands, std::size_t count, std::chrono::milliseconds timeout,
+													 Consumer&& consume)
+{
+	beginCommand(timeout);
+	writeCommands(commands, count);
+
+	for(std::size_t i = 0; i < count; i++)
+	{
+		auto consumeResponse = [&consume, i] (const char *begin, const char *end)
+		{
+			consume(i, begin, end);
+		};
+
+		if(log == nullptr) receive(consumeResponse, nullptr);
+		else
+		{
+			std::string output;
+			receive(consumeResponse, &output);
+			writeLog(commands[i].data(), commands[i].size(), output);
+		}
+	}
+}
+
+template<typename StreamT>
+template<typename Consumer, typename Handler>
+void StreamController<StreamT>::asyncSendCommandStreamed(const CommandBuffer& command, Consumer consume, Handler handler)
+{
+	typedef AsyncCommand<Consumer, Handler> Operation;
+	Operation operation { this, &command, std::move(consume), std::move(handler),
+						  log == nullptr ? nullptr : std::make_shared<std::string>(), Operation::Step::Write, 0 };
+
+	// The command state is shared with the timer and stream handlers, so it is only touched in the strand
+	strand.post([this, operation] () mutable
+	{
+		if(resynchronize)
+		{
+			istreamBuffer.consume(istreamBuffer.size());
+			resynchronize = false;
+		}
+
+		std::size_t commandId = ++asyncCommandId;
+		asyncExpired = false;
+
+		if(timeout > std::chrono::milliseconds::zero())
+		{
+			deadlineTimer.expires_from_now(timeout);
+			deadlineTimer.async_wait(strand.wrap([this, commandId] (const boost::system::error_code& error)
+			{
+				if(!error && commandId == asyncCommandId)
+				{
+					asyncExpired = true;
+					stream.cancel();
+				}
+			}));
+		}
+
+		const CommandBuffer& command = *operation.command;
+		std::array<ba::const_buffer, 2> buffers = {{ ba::buffer(command.data(), command.size()), ba::buffer(REQUEST_END) }};
+		ba::async_write(stream, buffers, strand.wrap(std::move(operation)));
+	});
+}
+
+template<typename StreamT>
+template<typename Consumer, typename Handler>
+void StreamController<StreamT>::AsyncCommand<Consumer, Handler>::operator()(const boost::system::error_code& error, std::size_t size)
+{
+	if(error)
+	{
+		finish(error);
+		return;
+	}
+
+	StreamController& c = *controller;
+	switch(step)
+	{
+		case Step::Write:
+			if(!c.readResponse)
+			{
+				finish(error);
+				return;
+			}
+
+			if(c.readCommand && !c.REQUEST_END.empty())
+			{
+				if(c.requestEndMatcher.getDelimiter() != c.REQUEST_END) c.requestEndMatcher.setDelimiter(c.REQUEST_END);
+				else c.requestEndMatcher.reset();
+
+				step = Step::Echo;
+				ba::async_read_until(c.stream, c.istreamBuffer, c.requestEndMatcher.condition(), c.strand.wrap(*this));
+				return;
+			}
+			break;
+
+		case Step::Echo:
+			c.istreamBuffer.consume(size);
+			break;
+
+		case Step::Response:
+			c.istreamBuffer.commit(size);
+			break;
+	}
+
+	if(step != Step::Response)
+	{
+		if(c.responseEndMatcher.getDelimiter() != c.RESPONSE_END) c.responseEndMatcher.setDelimiter(c.RESPONSE_END);
+		else c.responseEndMatcher.reset();
+
+		if(c.RESPONSE_END.empty())
+		{
+			finish(error);
+			return;
+		}
+
+		step = Step::Response;
+		searched = 0;
+	}
+
+	std::string *output = this->output.get();
+	Consumer& consume = this->consume;
+	auto consumeResponse = [output, &consume] (const char *begin, const char *end)
+	{
+		if(output != nullptr) output->append(begin, end);
+		consume(begin, end);
+	};
+
+	if(c.consumeUntil(c.responseEndMatcher, consumeResponse, searched)) finish(error);
+	else c.stream.async_read_some(c.istreamBuffer.prepare(READ_SIZE), c.strand.wrap(*this));
+}
+
+template<typename StreamT>
+template<typename Consumer, typename Handler>
+void StreamController<StreamT>::AsyncCommand<Consumer, Handler>::finish(const boost::system::error_code& error)
+{
+	StreamController& c = *controller;
+
+	c.asyncCommandId++;
+	c.deadlineTimer.cancel();
+
+	boost::system::error_code result = error;
+	if(c.asyncExpired)
+	{
+		c.istreamBuffer.consume(c.istreamBuffer.size());
+		c.resynchronize = true;
+
+		result = ba::error::timed_out;
+	}
+	else if(!error && output) c.writeLog(command->data(), command->size(), *output);
+
+	handler(result);
+}
+
+template<typename StreamT>
+template<typename Response, typename std::enable_if<std::is_void<Response>::value>::type*>
+void StreamController<StreamT>::sendCommand()
+{
+	std::string input = deviceInput.str();
+
+	deviceInput.clear();
+	deviceInput.str("");
+
+	exchange(input.data(), input.size(), timeout);
+}
+
+template<typename StreamT>
+template<typename Response, typename std::enable_if<!std::is_void<Response>::value>::type*>
+Response StreamController<StreamT>::sendCommand()
+{
+	sendCommand();
+	return outputAs<Response>();
+}
+
 template<typename StreamT>
 template<typename... Args>
 std::string StreamController<StreamT>::createFormattedCommand(const std::string& command, Args... params) const
 {
-	std::size_t size = std::snprintf(nullptr, 0, command.c_str(), params...) + 1;
-	char *buffer = new char[size];
-	std::snprintf(buffer, size, command.c_str(), params...);
+	char buffer[CommandBuffer::CAPACITY];
+	std::size_t size = std::snprintf(buffer, sizeof(buffer), command.c_str(), params...);
+	if(size < sizeof(buffer)) return std::string(buffer, size);
 
-	std::string result(buffer, buffer + size - 1);
-	delete[] buffer;
+	std::string result(size, '\0');
+	std::snprintf(&result[0], size + 1, command.c_str(), params...);
 
 	return result;
 }
@@ -0,0 +1,91 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_CONTROLLERMANAGER_HPP
+#define REGILO_CONTROLLERMANAGER_HPP
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+
+namespace regilo {
+
+namespace ba = boost::asio;
+
+/**
+ * @brief The ControllerManager class runs one IO service on a fixed pool of threads for many controllers.
+ *
+ * The controllers that are created by the manager share its IO service, so their asynchronous operations
+ * (e.g. IScanController::asyncGetScan) are driven by the pool instead of a thread per device. Handlers of every
+ * controller are serialized by its own strand. The controllers have to be destroyed before the manager.
+ */
+class ControllerManager
+{
+private:
+	ba::io_service ioService;
+	std::unique_ptr<ba::io_service::work> work;
+	std::vector<std::thread> threads;
+
+public:
+	/**
+	 * @brief Start the threads that run the IO service.
+	 * @param threadCount The number of threads (zero means the number of hardware threads).
+	 */
+	ControllerManager(std::size_t threadCount = 0);
+
+	/**
+	 * @brief Stop the IO service and join the threads.
+	 */
+	~ControllerManager();
+
+	ControllerManager(const ControllerManager&) = delete;
+	ControllerManager& operator=(const ControllerManager&) = delete;
+
+	/**
+	 * @brief Create a controller that uses the shared IO service.
+	 * @return The new controller.
+	 */
+	template<typename Controller>
+	inline std::shared_ptr<Controller> createController() { return std::make_shared<Controller>(ioService); }
+
+	/**
+	 * @brief Get the shared IO service.
+	 * @return The IO service.
+	 */
+	inline ba::io_service& getIoService() { return ioService; }
+
+	/**
+	 * @brief Get the number of threads that run the IO service.
+	 * @return The thread count.
+	 */
+	inline std::size_t getThreadCount() const { return threads.size(); }
+
+	/**
+	 * @brief Stop the IO service (the pending operations are abandoned) and join the threads.
+	 */
+	void stop();
+};
+
+}
+
+#endif // REGILO_CONTROLLERMANAGER_HPP
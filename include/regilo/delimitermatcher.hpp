@@ -0,0 +1,161 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_DELIMITERMATCHER_HPP
+#define REGILO_DELIMITERMATCHER_HPP
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/read_until.hpp>
+
+namespace regilo {
+
+/**
+ * @brief The DelimiterMatcher class finds a (multi-char) delimiter in data that arrive in parts.
+ *
+ * The matcher keeps the partially matched delimiter between the parts, so no data are searched twice.
+ * It uses the Knuth-Morris-Pratt algorithm (overlapping prefixes are handled correctly)
+ * and std::memchr to skip the data that cannot start the delimiter.
+ */
+class DelimiterMatcher
+{
+private:
+	std::string delimiter;
+	std::vector<std::size_t> failure;
+	std::size_t matched = 0;
+
+public:
+	/**
+	 * @brief The Condition class is a Boost.Asio match condition that uses a DelimiterMatcher (it can be used with ba::read_until).
+	 */
+	class Condition
+	{
+	private:
+		DelimiterMatcher *matcher;
+
+	public:
+		/**
+		 * @brief Construct a condition.
+		 * @param matcher The matcher that keeps the state.
+		 */
+		explicit Condition(DelimiterMatcher& matcher) : matcher(&matcher) {}
+
+		/**
+		 * @brief Search the data for the delimiter.
+		 * @return The iterator after the delimiter and true or the end iterator and false.
+		 */
+		template<typename Iterator>
+		std::pair<Iterator, bool> operator()(Iterator begin, Iterator end) const;
+	};
+
+	/**
+	 * @brief Construct a matcher.
+	 * @param delimiter The delimiter.
+	 */
+	DelimiterMatcher(const std::string& delimiter = "");
+
+	/**
+	 * @brief Get the delimiter.
+	 * @return The delimiter.
+	 */
+	inline const std::string& getDelimiter() const { return delimiter; }
+
+	/**
+	 * @brief Set a new delimiter (the matcher is reset).
+	 * @param delimiter The delimiter.
+	 */
+	void setDelimiter(const std::string& delimiter);
+
+	/**
+	 * @brief Forget the partially matched delimiter.
+	 */
+	inline void reset() { matched = 0; }
+
+	/**
+	 * @brief Get the number of delimiter characters at the end of the data that were processed so far.
+	 * @return The size of the partially matched delimiter.
+	 */
+	inline std::size_t getMatchedSize() const { return matched; }
+
+	/**
+	 * @brief Process one character.
+	 * @param c The character.
+	 * @return True if the character completes the delimiter (the matcher is reset then).
+	 */
+	inline bool match(char c);
+
+	/**
+	 * @brief Process the data until the delimiter is completed.
+	 * @param begin The first character of the data.
+	 * @param end The character after the last character of the data.
+	 * @return The pointer after the delimiter or nullptr if the delimiter is not completed in the data.
+	 */
+	const char* find(const char *begin, const char *end);
+
+	/**
+	 * @brief Get a Boost.Asio match condition that uses the matcher.
+	 * @return The match condition.
+	 */
+	inline Condition condition() { return Condition(*this); }
+};
+
+bool DelimiterMatcher::match(char c)
+{
+	while(matched != 0 && c != delimiter[matched]) matched = failure[matched - 1];
+	if(c == delimiter[matched]) matched++;
+
+	if(matched == delimiter.size())
+	{
+		matched = 0;
+		return true;
+	}
+
+	return false;
+}
+
+template<typename Iterator>
+std::pair<Iterator, bool> DelimiterMatcher::Condition::operator()(Iterator begin, Iterator end) const
+{
+	while(begin != end)
+	{
+		if(matcher->match(*begin++)) return std::make_pair(begin, true);
+	}
+
+	return std::make_pair(end, false);
+}
+
+}
+
+namespace boost {
+namespace asio {
+
+template<>
+struct is_match_condition<regilo::DelimiterMatcher::Condition> : public std::true_type
+{
+};
+
+}
+}
+
+#endif // REGILO_DELIMITERMATCHER_HPP
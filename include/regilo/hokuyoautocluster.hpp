@@ -0,0 +1,90 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef REGILO_HOKUYOAUTOCLUSTER_HPP
+#define REGILO_HOKUYOAUTOCLUSTER_HPP
+
+#include <chrono>
+#include <cstddef>
+
+namespace regilo {
+
+/**
+ * @brief The HokuyoAutoCluster class chooses the cluster count of Hokuyo scans from a target scan rate.
+ *
+ * The throughput of the link is measured from the received scan responses (the part after the first received
+ * chunk, so the waiting for the scan is not included). The chosen cluster count is the smallest one whose
+ * response can be transferred in the period of the target scan rate.
+ */
+class HokuyoAutoCluster
+{
+private:
+	double targetScanRate = 0;
+	double throughput = 0;
+
+public:
+	static constexpr double SMOOTHING = 0.2; ///< The weight of a new throughput measurement.
+	static const std::size_t MAX_CLUSTER_COUNT = 99; ///< The highest cluster count of the scan commands.
+
+	/**
+	 * @brief Get the target scan rate.
+	 * @return The rate (in Hz, zero means that the automatic mode is disabled).
+	 */
+	inline double getTargetScanRate() const { return targetScanRate; }
+
+	/**
+	 * @brief Set the target scan rate.
+	 * @param targetScanRate The rate (in Hz, zero disables the automatic mode).
+	 */
+	void setTargetScanRate(double targetScanRate);
+
+	/**
+	 * @brief Test if the automatic mode is enabled.
+	 * @return True if the target scan rate is set.
+	 */
+	inline bool isEnabled() const { return targetScanRate > 0; }
+
+	/**
+	 * @brief Get the measured throughput of the link.
+	 * @return The throughput (in bytes per second, zero if it is not measured yet).
+	 */
+	inline double getThroughput() const { return throughput; }
+
+	/**
+	 * @brief Add a measurement of a response transfer.
+	 * @param bytes The number of transferred bytes.
+	 * @param duration The duration of the transfer.
+	 */
+	void addTransfer(std::size_t bytes, std::chrono::steady_clock::duration duration);
+
+	/**
+	 * @brief Choose the cluster count for a scan.
+	 * @param stepCount The number of steps of the scan.
+	 * @param encoding The number of characters per value.
+	 * @param lineOverhead The number of characters that follow each data line (64 characters).
+	 * @param headerSize The number of characters of the response without the data lines.
+	 * @return The cluster count [1; MAX_CLUSTER_COUNT] or zero if the throughput is unknown.
+	 */
+	std::size_t getClusterCount(std::size_t stepCount, std::size_t encoding, std::size_t lineOverhead, std::size_t headerSize) const;
+};
+
+}
+
+#endif // REGILO_HOKUYOAUTOCLUSTER_HPP
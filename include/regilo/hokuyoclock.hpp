@@ -0,0 +1,138 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef REGILO_HOKUYOCLOCK_HPP
+#define REGILO_HOKUYOCLOCK_HPP
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+namespace regilo {
+
+/**
+ * @brief The HokuyoClock class maps the time stamps of a Hokuyo scanner to the monotonic (steady clock) timeline.
+ *
+ * The scanner clock counts milliseconds in 24 bits, so it wraps around after about 4.6 hours. The model
+ * is a line (offset and drift) fitted to the round trips of the time adjust mode (`TM1`). Between them,
+ * the time stamps of the scans keep the offset consistent: a scan cannot be captured after it was received.
+ * The offset is lowered by the most violating of the recent scans, so the correction is undone
+ * when the violating scans leave the window (e.g. after a delayed scan).
+ * All methods are thread-safe.
+ */
+class HokuyoClock
+{
+public:
+	typedef std::chrono::steady_clock::time_point TimePoint; ///< A point on the monotonic timeline.
+
+	static const long DEVICE_TIME_RANGE = 1L << 24; ///< The range of the scanner time stamps (in milliseconds).
+	static constexpr double MAX_DRIFT = 1e-3; ///< The maximal relative drift between the clocks.
+
+private:
+	struct Sample
+	{
+		double deviceTime;
+		double hostTime;
+	};
+
+	mutable std::mutex mutex;
+
+	std::size_t historySize;
+	std::deque<Sample> samples;
+	std::deque<Sample> scans;
+
+	TimePoint origin;
+	bool hasDeviceTime = false;
+	long long lastDeviceTime = 0;
+
+	double offset = 0;
+	double drift = 0;
+	double correction = 0;
+	std::chrono::steady_clock::duration accuracy = std::chrono::steady_clock::duration::max();
+
+	long long unwrap(long deviceTime) const;
+	void updateDeviceTime(long long deviceTime);
+	double predict(long long deviceTime) const;
+	void fit();
+	void updateCorrection();
+
+public:
+	/**
+	 * @brief Construct the clock.
+	 * @param historySize The number of round trips that the drift is fitted to (and the number of scans that correct the offset).
+	 */
+	HokuyoClock(std::size_t historySize = 32);
+
+	/**
+	 * @brief Forget all round trips (e.g. after the scanner is restarted).
+	 */
+	void reset();
+
+	/**
+	 * @brief Add a round trip of the time request.
+	 *
+	 * The scanner time is assumed to be taken in the middle of the round trip,
+	 * so the shortest round trips give the best estimates.
+	 *
+	 * @param sent The time when the request was sent.
+	 * @param received The time when the response was received.
+	 * @param deviceTime The time stamp of the scanner (in milliseconds).
+	 */
+	void addRoundTrip(TimePoint sent, TimePoint received, long deviceTime);
+
+	/**
+	 * @brief Add the time stamp of a received scan and get its capture time.
+	 * @param received The time when the scan was received.
+	 * @param deviceTime The time stamp of the scan (in milliseconds).
+	 * @param captureTime Output for the capture time (it is not after the received time).
+	 * @return False if the clock is not synchronized (the capture time is not set).
+	 */
+	bool addScan(TimePoint received, long deviceTime, TimePoint& captureTime);
+
+	/**
+	 * @brief Convert a time stamp of the scanner to the monotonic timeline.
+	 * @param deviceTime The time stamp (in milliseconds).
+	 * @param hostTime Output for the converted time.
+	 * @return False if the clock is not synchronized (the host time is not set).
+	 */
+	bool toHostTime(long deviceTime, TimePoint& hostTime) const;
+
+	/**
+	 * @brief Test if at least one round trip was added.
+	 * @return True if the time stamps can be converted.
+	 */
+	bool isSynchronized() const;
+
+	/**
+	 * @brief Get the drift of the scanner clock.
+	 * @return The relative difference of the host and the scanner clock rates (e.g. 1e-5 means 10 us per second).
+	 */
+	double getDrift() const;
+
+	/**
+	 * @brief Get the accuracy of the synchronization.
+	 * @return The half of the shortest round trip or the maximal duration if the clock is not synchronized.
+	 */
+	std::chrono::steady_clock::duration getAccuracy() const;
+};
+
+}
+
+#endif // REGILO_HOKUYOCLOCK_HPP
@@ -22,63 +22,41 @@
 #ifndef REGILO_HOKUYOCONTROLLER_HPP
 #define REGILO_HOKUYOCONTROLLER_HPP
 
-#include <cmath>
 #include <map>
 
 #include <boost/algorithm/string/trim.hpp>
 
-#include "scancontroller.hpp"
-#include "serialcontroller.hpp"
-#include "socketcontroller.hpp"
+#include "hokuyocontrollerbase.hpp"
+#include "hokuyoscanparser.hpp"
 
 namespace regilo {
 
-/**
- * @brief The IHokuyoController interface is used for the HokuyoController class.
- */
-class IHokuyoController : public virtual IScanController
-{
-public:
-	/**
-	 * @brief Default destructor.
-	 */
-	virtual ~IHokuyoController() = default;
-
-	/**
-	 * @brief Return information about the scanner version.
-	 * @return Key-value pairs with the information.
-	 */
-	virtual std::map<std::string, std::string> getVersionInfo() = 0;
-};
-
 /**
  * @brief The HokuyoController class is used to communicate with the Hokuyo scanner.
  */
 template<typename ProtocolController>
-class HokuyoController : public IHokuyoController, public ScanController<ProtocolController>
+class HokuyoController : public HokuyoControllerBase<ProtocolController, HokuyoScanParser>
 {
-private:
-	std::size_t validFromStep = 44;
-	std::size_t validToStep = 725;
-	std::size_t maxStep = 768;
-	std::size_t fromStep = 0;
-	std::size_t toStep = maxStep;
-	std::size_t clusterCount = 1;
-	double startAngle = -135 * M_PI / 180;
-
 protected:
-	virtual inline std::string getScanCommand() const override { return this->createFormattedCommand(CMD_GET_SCAN, fromStep, toStep, clusterCount); }
-	virtual bool parseScanData(std::istream& in, ScanData& data) override;
+	virtual void updateScanCommand() override;
+	virtual bool readGeometry(HokuyoGeometry& geometry, std::map<std::string, std::string>& versionInfo) override;
+	virtual void getScanLayout(std::size_t& encoding, std::size_t& lineOverhead, std::size_t& headerSize) const override;
 
 public:
-	static std::string CMD_GET_VERSION; ///< A command for getting the scanner version.
-	static std::string CMD_GET_SCAN; ///< A command for getting a scan.
+	static const CommandBuffer CMD_GET_VERSION; ///< A command for getting the scanner version.
+	static constexpr CommandDescriptor<'\0', command::Int<3>, command::Int<3>, command::Int<2>> CMD_GET_SCAN{"G"}; ///< A command for getting a scan.
 
 	/**
 	 * @brief Default constructor.
 	 */
 	HokuyoController();
 
+	/**
+	 * @brief Constructor that uses a shared IO service (e.g. from ControllerManager).
+	 * @param ioService The IO service that has to outlive the controller.
+	 */
+	HokuyoController(ba::io_service& ioService);
+
 	/**
 	 * @brief Constructor with a log file specified by a path.
 	 * @param logPath Path to the log file.
@@ -97,16 +75,10 @@ public:
 	virtual ~HokuyoController() = default;
 
 	virtual std::map<std::string, std::string> getVersionInfo() override;
-
-	/**
-	 * @brief Set parameters for the scan command.
-	 * @param fromStep The starting step [0; maxStep].
-	 * @param toStep The ending steop [0; maxStep].
-	 * @param clusterCount The cluster count [0; 99].
-	 */
-	void setScanParameters(std::size_t fromStep, std::size_t toStep, std::size_t clusterCount);
 };
 
+extern template class HokuyoControllerBase<SerialController, HokuyoScanParser>;
+extern template class HokuyoControllerBase<SocketController, HokuyoScanParser>;
 extern template class HokuyoController<SerialController>;
 extern template class HokuyoController<SocketController>;
 
@@ -114,27 +86,37 @@ typedef HokuyoController<SerialController> HokuyoSerialController;
 typedef HokuyoController<SocketController> HokuyoSocketController;
 
 template<typename ProtocolController>
-std::string HokuyoController<ProtocolController>::CMD_GET_VERSION = "V";
+const CommandBuffer HokuyoController<ProtocolController>::CMD_GET_VERSION("V");
 
 template<typename ProtocolController>
-std::string HokuyoController<ProtocolController>::CMD_GET_SCAN = "G%03d%03d%02d";
+constexpr CommandDescriptor<'\0', command::Int<3>, command::Int<3>, command::Int<2>> HokuyoController<ProtocolController>::CMD_GET_SCAN;
 
 template<typename ProtocolController>
-HokuyoController<ProtocolController>::HokuyoController() : ScanController<ProtocolController>()
+HokuyoController<ProtocolController>::HokuyoController() : HokuyoControllerBase<ProtocolController, HokuyoScanParser>()
 {
 	this->RESPONSE_END = "\n\n";
+	this->updateScanParameters();
 }
 
 template<typename ProtocolController>
-HokuyoController<ProtocolController>::HokuyoController(const std::string& logPath) : ScanController<ProtocolController>(logPath)
+HokuyoController<ProtocolController>::HokuyoController(ba::io_service& ioService) : HokuyoControllerBase<ProtocolController, HokuyoScanParser>(ioService)
 {
 	this->RESPONSE_END = "\n\n";
+	this->updateScanParameters();
 }
 
 template<typename ProtocolController>
-HokuyoController<ProtocolController>::HokuyoController(std::iostream& logStream) : ScanController<ProtocolController>(logStream)
+HokuyoController<ProtocolController>::HokuyoController(const std::string& logPath) : HokuyoControllerBase<ProtocolController, HokuyoScanParser>(logPath)
 {
 	this->RESPONSE_END = "\n\n";
+	this->updateScanParameters();
+}
+
+template<typename ProtocolController>
+HokuyoController<ProtocolController>::HokuyoController(std::iostream& logStream) : HokuyoControllerBase<ProtocolController, HokuyoScanParser>(logStream)
+{
+	this->RESPONSE_END = "\n\n";
+	this->updateScanParameters();
 }
 
 template<typename ProtocolController>
@@ -164,55 +146,30 @@ std::map<std::string, std::string> HokuyoController<ProtocolController>::getVers
 }
 
 template<typename ProtocolController>
-void HokuyoController<ProtocolController>::setScanParameters(std::size_t fromStep, std::size_t toStep, std::size_t clusterCount)
+void HokuyoController<ProtocolController>::updateScanCommand()
 {
-	if(fromStep > maxStep) throw std::invalid_argument("Invalid fromStep argument.");
-	if(toStep > maxStep) throw std::invalid_argument("Invalid fromStep argument.");
-	if(clusterCount > 99) throw std::invalid_argument("Invalid clusterCount argument.");
-	if(fromStep > toStep) throw std::invalid_argument("fromStep has to be lower than toStep.");
-
-	this->fromStep = fromStep;
-	this->toStep = toStep;
-	this->clusterCount = clusterCount;
+	CMD_GET_SCAN.serialize(this->scanCommand, this->fromStep, this->toStep, this->clusterCount);
 }
 
 template<typename ProtocolController>
-bool HokuyoController<ProtocolController>::parseScanData(std::istream& in, ScanData& data)
+bool HokuyoController<ProtocolController>::readGeometry(HokuyoGeometry& geometry, std::map<std::string, std::string>& versionInfo)
 {
-	char status;
-	in >> status;
-	if(status != '0') return false;
-
-	double resolution = M_PI / 512;
-
-	int lastId = 0;
-	std::size_t step = fromStep - 1;
-	while(in)
-	{
-		step++;
-
-		char high, low;
-		in >> high >> low;
-
-		if(step < validFromStep || step > validToStep) continue;
+	// The geometry is a part of the version information
+	if(versionInfo.empty()) versionInfo = getVersionInfo();
+	if(versionInfo.empty()) return false;
 
-		int id = lastId++;
-		double angle = step * resolution + startAngle;
-		int distance = ((high - '0') << 6) | (low - '0');
-		int errorCode = 0;
-		bool error = false;
-
-		if(distance < 20)
-		{
-			errorCode = distance;
-			distance = -1;
-			error = true;
-		}
+	geometry.setVersionInfo(versionInfo);
+	return true;
+}
 
-		data.emplace_back(id, angle, distance, -1, errorCode, error);
-	}
+template<typename ProtocolController>
+void HokuyoController<ProtocolController>::getScanLayout(std::size_t& encoding, std::size_t& lineOverhead, std::size_t& headerSize) const
+{
+	encoding = 2;
+	lineOverhead = 1;
 
-	return true;
+	// The echo, the status and the final line feed
+	headerSize = this->scanCommand.size() + 4;
 }
 
 }
@@ -0,0 +1,377 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_HOKUYOCONTROLLERBASE_HPP
+#define REGILO_HOKUYOCONTROLLERBASE_HPP
+
+#include <algorithm>
+#include <map>
+
+#include "hokuyoautocluster.hpp"
+#include "hokuyogeometry.hpp"
+#include "scancontroller.hpp"
+#include "serialcontroller.hpp"
+#include "socketcontroller.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The IHokuyoController interface is used for the Hokuyo controllers (see HokuyoControllerBase).
+ */
+class IHokuyoController : public virtual IScanController
+{
+public:
+	/**
+	 * @brief Default destructor.
+	 */
+	virtual ~IHokuyoController() = default;
+
+	/**
+	 * @brief Return information about the scanner version.
+	 * @return Key-value pairs with the information.
+	 */
+	virtual std::map<std::string, std::string> getVersionInfo() = 0;
+
+	/**
+	 * @brief Wait until the laser is on and the scanner returns valid scans.
+	 *
+	 * The scans are polled until the scanner reports a success status
+	 * and the ratio of records with an error drops below the threshold.
+	 *
+	 * @param timeout The maximum waiting time.
+	 * @param maxErrorRatio The maximum ratio of records with an error.
+	 * @param pollInterval The time between two polls.
+	 * @return True if the laser is ready, false if the timeout expired.
+	 */
+	virtual bool waitForLaser(std::chrono::milliseconds timeout, double maxErrorRatio = 0.8,
+							  std::chrono::milliseconds pollInterval = std::chrono::milliseconds(100)) = 0;
+
+	/**
+	 * @brief Get the geometry of the scanner steps.
+	 * @return The geometry (the URG-04LX values until another one is set or loaded).
+	 */
+	virtual const HokuyoGeometry& getGeometry() const = 0;
+
+	/**
+	 * @brief Set the geometry of the scanner steps.
+	 *
+	 * The scan parameters are reset to the full range of the new geometry (the cluster count is kept)
+	 * and the angle table is built again.
+	 *
+	 * @param geometry The geometry.
+	 * @throw std::invalid_argument If the geometry is not valid.
+	 */
+	virtual void setGeometry(const HokuyoGeometry& geometry) = 0;
+
+	/**
+	 * @brief Load the geometry from the scanner and use it (see setGeometry()).
+	 *
+	 * It should be called once after the controller is connected. If a cache directory is specified,
+	 * the geometry is cached there by the serial number of the scanner, so next time it is not queried again.
+	 *
+	 * @param cacheDirectory The cache directory (empty disables the cache).
+	 * @return False if the scanner does not provide a valid geometry (the current one is kept).
+	 */
+	virtual bool loadGeometry(const std::string& cacheDirectory = "") = 0;
+
+	/**
+	 * @brief Set parameters for the scan command.
+	 *
+	 * The parameters can be changed between any two scans (but not while asyncGetScan() is in progress).
+	 *
+	 * @param fromStep The starting step [0; maxStep].
+	 * @param toStep The ending step [0; maxStep].
+	 * @param clusterCount The cluster count [0; 99] (it is ignored if the target scan rate is set).
+	 * @throw std::invalid_argument If a parameter is out of its range.
+	 */
+	virtual void setScanParameters(std::size_t fromStep, std::size_t toStep, std::size_t clusterCount) = 0;
+
+	/**
+	 * @brief Set the scan parameters from a sector (the region of interest).
+	 * @param fromAngle The starting angle (in radians, zero is the front, it is rounded to the nearest step).
+	 * @param toAngle The ending angle (in radians).
+	 * @param clusterCount The cluster count [0; 99] (it is ignored if the target scan rate is set).
+	 * @throw std::invalid_argument If fromAngle is greater than toAngle.
+	 */
+	virtual void setScanSector(double fromAngle, double toAngle, std::size_t clusterCount) = 0;
+
+	/**
+	 * @brief Get the starting step of the scans.
+	 * @return The step.
+	 */
+	virtual std::size_t getFromStep() const = 0;
+
+	/**
+	 * @brief Get the ending step of the scans.
+	 * @return The step.
+	 */
+	virtual std::size_t getToStep() const = 0;
+
+	/**
+	 * @brief Get the cluster count of the scans.
+	 * @return The cluster count (the one that is chosen automatically if the target scan rate is set).
+	 */
+	virtual std::size_t getClusterCount() const = 0;
+
+	/**
+	 * @brief Get the target scan rate of the automatic cluster count (see HokuyoAutoCluster).
+	 * @return The rate (in Hz, zero means that the automatic mode is disabled).
+	 */
+	virtual double getTargetScanRate() const = 0;
+
+	/**
+	 * @brief Set the target scan rate of the automatic cluster count (see HokuyoAutoCluster).
+	 *
+	 * The cluster count is chosen again after every scan from the measured throughput of the link,
+	 * so the next scans can be transferred at the target rate. When it is disabled, the last cluster count is kept.
+	 *
+	 * @param targetScanRate The rate (in Hz, zero disables the automatic mode).
+	 */
+	virtual void setTargetScanRate(double targetScanRate) = 0;
+
+	/**
+	 * @brief Get the measured throughput of the link.
+	 * @return The throughput (in bytes per second, zero if it is not measured yet).
+	 */
+	virtual double getThroughput() const = 0;
+};
+
+/**
+ * @brief The HokuyoControllerBase class contains the scan parameters, the geometry and the automatic cluster count
+ * that are shared by the SCIP 1.1 (HokuyoController) and SCIP 2.0 (HokuyoScip2Controller) controllers.
+ *
+ * The subclasses serialize the scan command and read the geometry with the commands of their protocol.
+ */
+template<typename ProtocolController, typename ScanParserT>
+class HokuyoControllerBase : public IHokuyoController, public ScanController<ProtocolController>
+{
+protected:
+	HokuyoGeometry geometry; ///< The geometry of the scanner steps.
+	std::size_t fromStep = 0; ///< The starting step of the scans.
+	std::size_t toStep = geometry.getMaxStep(); ///< The ending step of the scans.
+	std::size_t clusterCount = 1; ///< The cluster count of the scans.
+
+	std::shared_ptr<const AngleTable> angleTable; ///< The angle table of the current scan parameters.
+	ScanParserT scanParser; ///< The parser of the scan responses.
+	CommandBuffer scanCommand; ///< The scan command with the current scan parameters.
+	HokuyoAutoCluster autoCluster; ///< The automatic cluster count.
+
+	/**
+	 * @brief Build the scan command and the angle table again after the scan parameters are changed.
+	 *
+	 * It has to be called by the constructors of the subclasses (it calls updateScanCommand()).
+	 */
+	void updateScanParameters();
+
+	/**
+	 * @brief Serialize the scan command of the protocol into scanCommand and set the protocol specific parser options.
+	 */
+	virtual void updateScanCommand() = 0;
+
+	/**
+	 * @brief Read the geometry from the scanner.
+	 * @param geometry Output for the geometry.
+	 * @param versionInfo The version information if it was already requested by loadGeometry() (empty otherwise).
+	 * @return False if the scanner does not provide the geometry.
+	 */
+	virtual bool readGeometry(HokuyoGeometry& geometry, std::map<std::string, std::string>& versionInfo) = 0;
+
+	/**
+	 * @brief Get the layout of the scan response that is used for the automatic cluster count.
+	 * @param encoding Output for the number of characters per value.
+	 * @param lineOverhead Output for the number of characters after every data line.
+	 * @param headerSize Output for the number of characters before the data (including the final line feed).
+	 */
+	virtual void getScanLayout(std::size_t& encoding, std::size_t& lineOverhead, std::size_t& headerSize) const = 0;
+
+	virtual inline const CommandBuffer& getScanCommand() const override { return scanCommand; }
+	virtual inline ScanParser& getScanParser() override { return scanParser; }
+	virtual void endDeviceScan(ScanData& data) override;
+
+public:
+	/**
+	 * @brief Default constructor.
+	 */
+	HokuyoControllerBase() = default;
+
+	/**
+	 * @brief Constructor that uses a shared IO service (e.g. from ControllerManager).
+	 * @param ioService The IO service that has to outlive the controller.
+	 */
+	HokuyoControllerBase(ba::io_service& ioService) : ScanController<ProtocolController>(ioService) {}
+
+	/**
+	 * @brief Constructor with a log file specified by a path.
+	 * @param logPath Path to the log file.
+	 */
+	HokuyoControllerBase(const std::string& logPath) : ScanController<ProtocolController>(logPath) {}
+
+	/**
+	 * @brief Constructor with a log specified by a stream.
+	 * @param logStream The log stream.
+	 */
+	HokuyoControllerBase(std::iostream& logStream) : ScanController<ProtocolController>(logStream) {}
+
+	/**
+	 * @brief Default destructor.
+	 */
+	virtual ~HokuyoControllerBase() = default;
+
+	virtual bool waitForLaser(std::chrono::milliseconds timeout, double maxErrorRatio = 0.8,
+							  std::chrono::milliseconds pollInterval = std::chrono::milliseconds(100)) override;
+
+	virtual inline const HokuyoGeometry& getGeometry() const override { return geometry; }
+	virtual void setGeometry(const HokuyoGeometry& geometry) override;
+	virtual bool loadGeometry(const std::string& cacheDirectory = "") override;
+
+	virtual void setScanParameters(std::size_t fromStep, std::size_t toStep, std::size_t clusterCount) override;
+	virtual void setScanSector(double fromAngle, double toAngle, std::size_t clusterCount) override;
+	virtual inline std::size_t getFromStep() const override { return fromStep; }
+	virtual inline std::size_t getToStep() const override { return toStep; }
+	virtual inline std::size_t getClusterCount() const override { return clusterCount; }
+
+	virtual inline double getTargetScanRate() const override { return autoCluster.getTargetScanRate(); }
+	virtual inline void setTargetScanRate(double targetScanRate) override { autoCluster.setTargetScanRate(targetScanRate); }
+	virtual inline double getThroughput() const override { return autoCluster.getThroughput(); }
+
+	/**
+	 * @brief Get the precomputed angles of scan records for the current scan parameters.
+	 * @return The angle table that is also attached to every ScanData.
+	 */
+	inline std::shared_ptr<const AngleTable> getAngleTable() const { return angleTable; }
+};
+
+template<typename ProtocolController, typename ScanParserT>
+bool HokuyoControllerBase<ProtocolController, ScanParserT>::waitForLaser(std::chrono::milliseconds timeout, double maxErrorRatio,
+																		 std::chrono::milliseconds pollInterval)
+{
+	return this->waitForValidScans(timeout, maxErrorRatio, -1, pollInterval);
+}
+
+template<typename ProtocolController, typename ScanParserT>
+void HokuyoControllerBase<ProtocolController, ScanParserT>::endDeviceScan(ScanData& data)
+{
+	// A response that is received in one part has no tail, so the whole response is measured from the command (with the latency)
+	if(this->responseTailSize != 0) autoCluster.addTransfer(this->responseTailSize, data.steadyTime - this->responseStartTime);
+	else autoCluster.addTransfer(this->responseSize, data.steadyTime - this->responseSentTime);
+
+	std::size_t encoding, lineOverhead, headerSize;
+	getScanLayout(encoding, lineOverhead, headerSize);
+
+	std::size_t newClusterCount = autoCluster.getClusterCount(toStep - fromStep + 1, encoding, lineOverhead, headerSize);
+	if(newClusterCount != 0 && newClusterCount != clusterCount)
+	{
+		clusterCount = newClusterCount;
+		updateScanParameters();
+	}
+}
+
+template<typename ProtocolController, typename ScanParserT>
+void HokuyoControllerBase<ProtocolController, ScanParserT>::setGeometry(const HokuyoGeometry& geometry)
+{
+	if(!geometry.isValid()) throw std::invalid_argument("Invalid geometry.");
+
+	this->geometry = geometry;
+	fromStep = 0;
+	toStep = geometry.getMaxStep();
+
+	updateScanParameters();
+}
+
+template<typename ProtocolController, typename ScanParserT>
+bool HokuyoControllerBase<ProtocolController, ScanParserT>::loadGeometry(const std::string& cacheDirectory)
+{
+	HokuyoGeometry newGeometry;
+	std::map<std::string, std::string> versionInfo;
+	std::string cachePath;
+
+	if(!cacheDirectory.empty())
+	{
+		versionInfo = getVersionInfo();
+
+		auto serialNumber = versionInfo.find("SERI");
+		if(serialNumber != versionInfo.end())
+		{
+			cachePath = HokuyoGeometry::getCachePath(cacheDirectory, serialNumber->second);
+			if(newGeometry.load(cachePath))
+			{
+				setGeometry(newGeometry);
+				return true;
+			}
+		}
+	}
+
+	if(!readGeometry(newGeometry, versionInfo) || !newGeometry.isValid()) return false;
+
+	setGeometry(newGeometry);
+	if(!cachePath.empty()) newGeometry.save(cachePath);
+
+	return true;
+}
+
+template<typename ProtocolController, typename ScanParserT>
+void HokuyoControllerBase<ProtocolController, ScanParserT>::setScanSector(double fromAngle, double toAngle, std::size_t clusterCount)
+{
+	setScanParameters(geometry.getStep(fromAngle), geometry.getStep(toAngle), clusterCount);
+}
+
+template<typename ProtocolController, typename ScanParserT>
+void HokuyoControllerBase<ProtocolController, ScanParserT>::setScanParameters(std::size_t fromStep, std::size_t toStep, std::size_t clusterCount)
+{
+	std::size_t maxStep = geometry.getMaxStep();
+
+	if(fromStep > maxStep) throw std::invalid_argument("Invalid fromStep argument.");
+	if(toStep > maxStep) throw std::invalid_argument("Invalid toStep argument.");
+	if(clusterCount > 99) throw std::invalid_argument("Invalid clusterCount argument.");
+	if(fromStep > toStep) throw std::invalid_argument("fromStep has to be lower than toStep.");
+
+	this->fromStep = fromStep;
+	this->toStep = toStep;
+	if(!autoCluster.isEnabled()) this->clusterCount = clusterCount;
+
+	updateScanParameters();
+}
+
+template<typename ProtocolController, typename ScanParserT>
+void HokuyoControllerBase<ProtocolController, ScanParserT>::updateScanParameters()
+{
+	updateScanCommand();
+
+	std::size_t stepIncrement = std::max<std::size_t>(clusterCount, 1);
+	std::size_t validFromStep = geometry.validFromStep;
+	std::size_t validToStep = geometry.validToStep;
+	std::size_t minDistance = geometry.minDistance;
+	double resolution = geometry.getResolution();
+	double startAngle = geometry.getStartAngle();
+
+	std::size_t firstStep = fromStep;
+	if(firstStep < validFromStep) firstStep += (validFromStep - firstStep + stepIncrement - 1) / stepIncrement * stepIncrement;
+
+	std::size_t lastStep = std::min(toStep, validToStep);
+	std::size_t size = (firstStep <= lastStep ? (lastStep - firstStep) / stepIncrement + 1 : 0);
+
+	angleTable = std::make_shared<const AngleTable>(firstStep, size, stepIncrement, resolution, startAngle);
+	scanParser.setParameters(fromStep, stepIncrement, validFromStep, validToStep, minDistance, resolution, startAngle, angleTable);
+}
+
+}
+
+#endif // REGILO_HOKUYOCONTROLLERBASE_HPP
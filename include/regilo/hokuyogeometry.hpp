@@ -0,0 +1,126 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef REGILO_HOKUYOGEOMETRY_HPP
+#define REGILO_HOKUYOGEOMETRY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+namespace regilo {
+
+/**
+ * @brief The HokuyoGeometry class describes the steps of a Hokuyo scanner.
+ *
+ * The default values describe the URG-04LX. The values of other models can be read from the SCIP 2.0 `PP`
+ * parameters or from the SCIP 1.1 version information, and they can be cached in a file (in the `PP` format).
+ */
+class HokuyoGeometry
+{
+public:
+	std::size_t validFromStep = 44; ///< The first step with a valid measurement (`AMIN`).
+	std::size_t validToStep = 725; ///< The last step with a valid measurement (`AMAX`).
+	std::size_t stepsPerRevolution = 1024; ///< The number of steps in 360 degrees (`ARES`).
+	std::size_t frontStep = 384; ///< The step in the front direction (`AFRT`).
+	std::size_t minDistance = 20; ///< The minimal distance (`DMIN`, in millimeters).
+	std::size_t maxDistance = 4095; ///< The maximal distance (`DMAX`, in millimeters).
+	std::size_t scanSpeed = 600; ///< The rotation speed (`SCAN`, in rpm).
+
+	/**
+	 * @brief Get the highest step that is accepted by the scan commands.
+	 * @return The maximum of validToStep and three quarters of a revolution.
+	 */
+	inline std::size_t getMaxStep() const { return std::max(validToStep, stepsPerRevolution * 3 / 4); }
+
+	/**
+	 * @brief Get the angle between two steps.
+	 * @return The resolution (in radians).
+	 */
+	inline double getResolution() const { return 2 * M_PI / stepsPerRevolution; }
+
+	/**
+	 * @brief Get the angle of the step zero.
+	 * @return The angle (in radians, the front step has zero angle).
+	 */
+	inline double getStartAngle() const { return -double(frontStep) * getResolution(); }
+
+	/**
+	 * @brief Get the nearest step of an angle.
+	 * @param angle The angle (in radians, the front step has zero angle).
+	 * @return The step [0; getMaxStep()].
+	 */
+	std::size_t getStep(double angle) const;
+
+	/**
+	 * @brief Test if the geometry is consistent.
+	 * @return True if the values can be used for scans.
+	 */
+	bool isValid() const;
+
+	/**
+	 * @brief Set the values from the SCIP 2.0 `PP` parameters (the missing ones are kept).
+	 * @param parameters The parameters.
+	 */
+	void setParameters(const std::map<std::string, std::string>& parameters);
+
+	/**
+	 * @brief Get the values as the SCIP 2.0 `PP` parameters.
+	 * @return The parameters.
+	 */
+	std::map<std::string, std::string> getParameters() const;
+
+	/**
+	 * @brief Set the values from the SCIP 1.1 version information.
+	 *
+	 * The `FIRM` value of the older firmwares contains the ranges,
+	 * e.g. "3.3.00,08/04/16(20-4095[mm],240[deg],44-725[step],600[rpm])". The missing values are kept.
+	 *
+	 * @param versionInfo The version information.
+	 */
+	void setVersionInfo(const std::map<std::string, std::string>& versionInfo);
+
+	/**
+	 * @brief Load the geometry from a file (the `PP` format).
+	 * @param path The file path.
+	 * @return False if the file does not exist or it does not contain a valid geometry.
+	 */
+	bool load(const std::string& path);
+
+	/**
+	 * @brief Save the geometry to a file (the `PP` format).
+	 * @param path The file path.
+	 * @return False if the file cannot be written.
+	 */
+	bool save(const std::string& path) const;
+
+	/**
+	 * @brief Get the path of the cached geometry of a scanner.
+	 * @param directory The cache directory.
+	 * @param serialNumber The serial number of the scanner (`SERI`).
+	 * @return The file path.
+	 */
+	static std::string getCachePath(const std::string& directory, const std::string& serialNumber);
+};
+
+}
+
+#endif // REGILO_HOKUYOGEOMETRY_HPP
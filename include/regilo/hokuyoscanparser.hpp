@@ -0,0 +1,82 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_HOKUYOSCANPARSER_HPP
+#define REGILO_HOKUYOSCANPARSER_HPP
+
+#include "scanparser.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The HokuyoScanParser class parses the output of the Hokuyo (SCIP 1.1) `G` command.
+ *
+ * The output is a status line followed by the distances encoded in two characters per step.
+ * Every record is stored as soon as both of its characters are received.
+ */
+class HokuyoScanParser : public ScanParser
+{
+private:
+	enum class State { Status, Data, Failed };
+
+	std::size_t fromStep = 0;
+	std::size_t stepIncrement = 1;
+	std::size_t validFromStep = 0;
+	std::size_t validToStep = 0;
+	std::size_t minDistance = 20;
+	double resolution = 0;
+	double startAngle = 0;
+	std::shared_ptr<const AngleTable> angleTable;
+
+	State state = State::Status;
+	char high = 0;
+	bool hasHigh = false;
+	std::size_t step = 0;
+	int lastId = 0;
+	bool tableAngles = true;
+
+	void parseValue(char high, char low);
+
+protected:
+	virtual void reset() override;
+	virtual bool finish() override;
+
+public:
+	/**
+	 * @brief Set the scan parameters that the raw data correspond to.
+	 * @param fromStep The starting step.
+	 * @param stepIncrement The number of steps per value (the cluster count).
+	 * @param validFromStep The first step with a valid measurement.
+	 * @param validToStep The last step with a valid measurement.
+	 * @param minDistance The minimal valid distance (in millimeters), the smaller values are error codes.
+	 * @param resolution The angle between two steps (in radians).
+	 * @param startAngle The angle of the step zero (in radians).
+	 * @param angleTable The angles of the valid steps.
+	 */
+	void setParameters(std::size_t fromStep, std::size_t stepIncrement, std::size_t validFromStep, std::size_t validToStep,
+					   std::size_t minDistance, double resolution, double startAngle, std::shared_ptr<const AngleTable> angleTable);
+
+	virtual void parse(const char *begin, const char *end) override;
+};
+
+}
+
+#endif // REGILO_HOKUYOSCANPARSER_HPP
@@ -0,0 +1,439 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef REGILO_HOKUYOSCIP2CONTROLLER_HPP
+#define REGILO_HOKUYOSCIP2CONTROLLER_HPP
+
+#include <map>
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include "hokuyoclock.hpp"
+#include "hokuyocontrollerbase.hpp"
+#include "hokuyoscip2scanparser.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The HokuyoScip2Controller class is used to communicate with the Hokuyo scanner with the SCIP 2.0 protocol.
+ *
+ * Scans are requested by `GD` (three characters per value, the full range of newer URG models)
+ * or `GS` (two characters per value, a shorter response). All lines of the responses are validated
+ * by their checksums (see HokuyoScip2ScanParser).
+ */
+template<typename ProtocolController>
+class HokuyoScip2Controller : public HokuyoControllerBase<ProtocolController, HokuyoScip2ScanParser>
+{
+public:
+	/**
+	 * @brief The Encoding enum specifies the command that is used for the scans.
+	 */
+	enum class Encoding
+	{
+		TwoCharacters, ///< `GS` (distances up to 4095 mm).
+		ThreeCharacters ///< `GD` (distances up to 262143 mm).
+	};
+
+private:
+	Encoding encoding = Encoding::ThreeCharacters;
+	bool laser = false;
+	HokuyoClock clock;
+
+	std::map<std::string, std::string> getInfo(const CommandBuffer& command);
+	long getDeviceTime();
+	void endTimeAdjust();
+
+protected:
+	virtual void updateScanCommand() override;
+	virtual bool readGeometry(HokuyoGeometry& geometry, std::map<std::string, std::string>& versionInfo) override;
+	virtual void getScanLayout(std::size_t& encoding, std::size_t& lineOverhead, std::size_t& headerSize) const override;
+	virtual void endDeviceScan(ScanData& data) override;
+
+public:
+	static const CommandBuffer CMD_SCIP2; ///< A command that switches a SCIP 1.1 scanner to SCIP 2.0.
+	static const CommandBuffer CMD_GET_VERSION; ///< The `VV` command (the version information).
+	static const CommandBuffer CMD_GET_PARAMETERS; ///< The `PP` command (the sensor parameters).
+	static const CommandBuffer CMD_GET_STATUS; ///< The `II` command (the sensor status).
+	static const CommandBuffer CMD_LASER_ON; ///< The `BM` command.
+	static const CommandBuffer CMD_LASER_OFF; ///< The `QT` command.
+	static const CommandBuffer CMD_TIME_ADJUST_BEGIN; ///< The `TM0` command (enter the time adjust mode).
+	static const CommandBuffer CMD_GET_TIME; ///< The `TM1` command (the scanner time in the time adjust mode).
+	static const CommandBuffer CMD_TIME_ADJUST_END; ///< The `TM2` command (leave the time adjust mode).
+	static constexpr CommandDescriptor<'\0', command::Int<4>, command::Int<4>, command::Int<2>> CMD_GET_SCAN{"GD"}; ///< A command for getting a scan (three characters per value).
+	static constexpr CommandDescriptor<'\0', command::Int<4>, command::Int<4>, command::Int<2>> CMD_GET_SHORT_SCAN{"GS"}; ///< A command for getting a scan (two characters per value).
+
+	/**
+	 * @brief Default constructor.
+	 */
+	HokuyoScip2Controller();
+
+	/**
+	 * @brief Constructor that uses a shared IO service (e.g. from ControllerManager).
+	 * @param ioService The IO service that has to outlive the controller.
+	 */
+	HokuyoScip2Controller(ba::io_service& ioService);
+
+	/**
+	 * @brief Constructor with a log file specified by a path.
+	 * @param logPath Path to the log file.
+	 */
+	HokuyoScip2Controller(const std::string& logPath);
+
+	/**
+	 * @brief Constructor with a log specified by a stream.
+	 * @param logStream The log stream.
+	 */
+	HokuyoScip2Controller(std::iostream& logStream);
+
+	/**
+	 * @brief Default destructor.
+	 */
+	virtual ~HokuyoScip2Controller() = default;
+
+	virtual inline std::map<std::string, std::string> getVersionInfo() override { return getInfo(CMD_GET_VERSION); }
+
+	/**
+	 * @brief Return the sensor parameters (`PP`).
+	 * @return Key-value pairs with the parameters (e.g. AMIN, AMAX, ARES, AFRT).
+	 */
+	inline std::map<std::string, std::string> getParameters() { return getInfo(CMD_GET_PARAMETERS); }
+
+	/**
+	 * @brief Return the sensor status (`II`).
+	 * @return Key-value pairs with the status.
+	 */
+	inline std::map<std::string, std::string> getStatusInfo() { return getInfo(CMD_GET_STATUS); }
+
+	/**
+	 * @brief Switch a scanner that starts in the SCIP 1.1 mode (e.g. URG-04LX) to SCIP 2.0.
+	 */
+	void switchToScip2();
+
+	/**
+	 * @brief Get whether the laser was turned on by setLaser().
+	 * @return True if the laser is on.
+	 */
+	inline bool getLaser() const { return laser; }
+
+	/**
+	 * @brief Turn the laser on (`BM`) or off (`QT`).
+	 * @param laser True for turning the laser on.
+	 * @throw std::runtime_error If the scanner refuses the command.
+	 */
+	void setLaser(bool laser);
+
+	/**
+	 * @brief Get the encoding of the scans.
+	 * @return The encoding.
+	 */
+	inline Encoding getEncoding() const { return encoding; }
+
+	/**
+	 * @brief Set the encoding of the scans (`GD` or `GS`).
+	 * @param encoding The encoding.
+	 */
+	void setEncoding(Encoding encoding);
+
+	/**
+	 * @brief Get the number of lines with a wrong checksum in the last scan.
+	 * @return The number of corrupt lines (their records have HokuyoScip2ScanParser::CHECKSUM_ERROR_CODE).
+	 */
+	inline std::size_t getCorruptLines() const { return this->scanParser.getCorruptLines(); }
+
+	/**
+	 * @brief Synchronize the scanner clock with the monotonic timeline.
+	 *
+	 * The scanner is switched to the time adjust mode and its time is requested several times.
+	 * The shortest round trip is added to the clock model, so the drift is estimated when it is called
+	 * repeatedly (e.g. every few minutes). The scans are stopped in the time adjust mode, so the laser
+	 * is turned on again if it was on. It is done even if a time request fails (its error is rethrown).
+	 *
+	 * @param roundTrips The number of time requests.
+	 * @return False if the scanner does not support the time adjust mode.
+	 */
+	bool synchronizeClock(std::size_t roundTrips = 10);
+
+	/**
+	 * @brief Get the model of the scanner clock.
+	 *
+	 * If it is synchronized, ScanData::steadyTime and ScanData::time of the scans are the capture times
+	 * that are computed from the scanner time stamps.
+	 *
+	 * @return The clock model.
+	 */
+	inline HokuyoClock& getClock() { return clock; }
+};
+
+extern template class HokuyoControllerBase<SerialController, HokuyoScip2ScanParser>;
+extern template class HokuyoControllerBase<SocketController, HokuyoScip2ScanParser>;
+extern template class HokuyoScip2Controller<SerialController>;
+extern template class HokuyoScip2Controller<SocketController>;
+
+typedef HokuyoScip2Controller<SerialController> HokuyoScip2SerialController;
+typedef HokuyoScip2Controller<SocketController> HokuyoScip2SocketController;
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_SCIP2("SCIP2.0");
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_GET_VERSION("VV");
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_GET_PARAMETERS("PP");
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_GET_STATUS("II");
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_LASER_ON("BM");
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_LASER_OFF("QT");
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_TIME_ADJUST_BEGIN("TM0");
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_GET_TIME("TM1");
+
+template<typename ProtocolController>
+const CommandBuffer HokuyoScip2Controller<ProtocolController>::CMD_TIME_ADJUST_END("TM2");
+
+template<typename ProtocolController>
+constexpr CommandDescriptor<'\0', command::Int<4>, command::Int<4>, command::Int<2>> HokuyoScip2Controller<ProtocolController>::CMD_GET_SCAN;
+
+template<typename ProtocolController>
+constexpr CommandDescriptor<'\0', command::Int<4>, command::Int<4>, command::Int<2>> HokuyoScip2Controller<ProtocolController>::CMD_GET_SHORT_SCAN;
+
+template<typename ProtocolController>
+HokuyoScip2Controller<ProtocolController>::HokuyoScip2Controller() : HokuyoControllerBase<ProtocolController, HokuyoScip2ScanParser>()
+{
+	this->RESPONSE_END = "\n\n";
+	this->updateScanParameters();
+}
+
+template<typename ProtocolController>
+HokuyoScip2Controller<ProtocolController>::HokuyoScip2Controller(ba::io_service& ioService) : HokuyoControllerBase<ProtocolController, HokuyoScip2ScanParser>(ioService)
+{
+	this->RESPONSE_END = "\n\n";
+	this->updateScanParameters();
+}
+
+template<typename ProtocolController>
+HokuyoScip2Controller<ProtocolController>::HokuyoScip2Controller(const std::string& logPath) : HokuyoControllerBase<ProtocolController, HokuyoScip2ScanParser>(logPath)
+{
+	this->RESPONSE_END = "\n\n";
+	this->updateScanParameters();
+}
+
+template<typename ProtocolController>
+HokuyoScip2Controller<ProtocolController>::HokuyoScip2Controller(std::iostream& logStream) : HokuyoControllerBase<ProtocolController, HokuyoScip2ScanParser>(logStream)
+{
+	this->RESPONSE_END = "\n\n";
+	this->updateScanParameters();
+}
+
+template<typename ProtocolController>
+std::map<std::string, std::string> HokuyoScip2Controller<ProtocolController>::getInfo(const CommandBuffer& command)
+{
+	std::map<std::string, std::string> info;
+
+	std::string status = ProtocolController::template sendCommand<std::string>(command);
+	if(status.compare(0, 2, "00") != 0) return info;
+
+	std::string line;
+	while(std::getline(this->deviceOutput, line))
+	{
+		if(!line.empty() && line.back() == '\r') line.pop_back();
+
+		// The checksum follows the last semicolon
+		std::size_t semicolonPos = line.rfind(';');
+		if(semicolonPos == std::string::npos || semicolonPos + 2 != line.size()) continue;
+		if(HokuyoScip2ScanParser::checksum(line.data(), line.data() + semicolonPos) != line.back()) continue;
+
+		std::size_t colonPos = line.find(':');
+		if(colonPos == std::string::npos || colonPos > semicolonPos) continue;
+
+		std::string name = line.substr(0, colonPos);
+		std::string value = line.substr(colonPos + 1, semicolonPos - colonPos - 1);
+
+		boost::algorithm::trim(name);
+		boost::algorithm::trim(value);
+
+		info[name] = value;
+	}
+
+	return info;
+}
+
+template<typename ProtocolController>
+long HokuyoScip2Controller<ProtocolController>::getDeviceTime()
+{
+	std::string status = ProtocolController::template sendCommand<std::string>(CMD_GET_TIME);
+	if(status.compare(0, 2, "00") != 0) return -1;
+
+	std::string line;
+	while(std::getline(this->deviceOutput, line))
+	{
+		if(!line.empty() && line.back() == '\r') line.pop_back();
+		if(line.empty()) continue;
+
+		// Four characters of the time and the checksum
+		if(line.size() != 5 || HokuyoScip2ScanParser::checksum(line.data(), line.data() + 4) != line.back()) return -1;
+		return HokuyoScip2ScanParser::decode(line.data(), line.data() + 4);
+	}
+
+	return -1;
+}
+
+template<typename ProtocolController>
+void HokuyoScip2Controller<ProtocolController>::getScanLayout(std::size_t& encoding, std::size_t& lineOverhead, std::size_t& headerSize) const
+{
+	encoding = this->scanParser.getEncoding();
+
+	// Every data line ends with the checksum
+	lineOverhead = 2;
+
+	// The echo, the status, the time stamp and the final line feed
+	headerSize = this->scanCommand.size() + 12;
+}
+
+template<typename ProtocolController>
+void HokuyoScip2Controller<ProtocolController>::endDeviceScan(ScanData& data)
+{
+	HokuyoControllerBase<ProtocolController, HokuyoScip2ScanParser>::endDeviceScan(data);
+
+	long timestamp = this->scanParser.getTimestamp();
+	if(timestamp < 0) return;
+
+	HokuyoClock::TimePoint captureTime;
+	if(clock.addScan(data.steadyTime, timestamp, captureTime))
+	{
+		data.time += std::chrono::duration_cast<std::chrono::milliseconds>(captureTime - data.steadyTime).count();
+		data.steadyTime = captureTime;
+	}
+}
+
+template<typename ProtocolController>
+void HokuyoScip2Controller<ProtocolController>::endTimeAdjust()
+{
+	ProtocolController::template sendCommand<>(CMD_TIME_ADJUST_END);
+	if(laser) setLaser(true);
+}
+
+template<typename ProtocolController>
+bool HokuyoScip2Controller<ProtocolController>::synchronizeClock(std::size_t roundTrips)
+{
+	std::string status = ProtocolController::template sendCommand<std::string>(CMD_TIME_ADJUST_BEGIN);
+
+	// 02 means that the scanner is already in the time adjust mode
+	if(status.compare(0, 2, "00") != 0 && status.compare(0, 2, "02") != 0) return false;
+
+	bool synchronized = false;
+	HokuyoClock::TimePoint bestSent, bestReceived;
+	long bestTime = -1;
+
+	try
+	{
+		for(std::size_t i = 0; i < roundTrips; i++)
+		{
+			HokuyoClock::TimePoint sent = std::chrono::steady_clock::now();
+			long deviceTime = getDeviceTime();
+			HokuyoClock::TimePoint received = std::chrono::steady_clock::now();
+
+			if(deviceTime >= 0 && (!synchronized || received - sent < bestReceived - bestSent))
+			{
+				bestSent = sent;
+				bestReceived = received;
+				bestTime = deviceTime;
+				synchronized = true;
+			}
+		}
+	}
+	catch(...)
+	{
+		// The scanner must not stay in the time adjust mode, but the original error is reported
+		try
+		{
+			endTimeAdjust();
+		}
+		catch(...) {}
+
+		throw;
+	}
+
+	endTimeAdjust();
+
+	if(synchronized) clock.addRoundTrip(bestSent, bestReceived, bestTime);
+
+	return synchronized;
+}
+
+template<typename ProtocolController>
+void HokuyoScip2Controller<ProtocolController>::switchToScip2()
+{
+	ProtocolController::template sendCommand<>(CMD_SCIP2);
+}
+
+template<typename ProtocolController>
+void HokuyoScip2Controller<ProtocolController>::setLaser(bool laser)
+{
+	std::string status = ProtocolController::template sendCommand<std::string>(laser ? CMD_LASER_ON : CMD_LASER_OFF);
+
+	// 02 means that the laser is already on
+	if(status.compare(0, 2, "00") != 0 && !(laser && status.compare(0, 2, "02") == 0))
+	{
+		throw std::runtime_error("The scanner refused to turn the laser " + std::string(laser ? "on" : "off") + " (status " + status + ").");
+	}
+
+	this->laser = laser;
+}
+
+template<typename ProtocolController>
+void HokuyoScip2Controller<ProtocolController>::setEncoding(Encoding encoding)
+{
+	this->encoding = encoding;
+	this->updateScanParameters();
+}
+
+template<typename ProtocolController>
+void HokuyoScip2Controller<ProtocolController>::updateScanCommand()
+{
+	if(encoding == Encoding::ThreeCharacters) CMD_GET_SCAN.serialize(this->scanCommand, this->fromStep, this->toStep, this->clusterCount);
+	else CMD_GET_SHORT_SCAN.serialize(this->scanCommand, this->fromStep, this->toStep, this->clusterCount);
+
+	this->scanParser.setEncoding(encoding == Encoding::ThreeCharacters ? 3 : 2);
+}
+
+template<typename ProtocolController>
+bool HokuyoScip2Controller<ProtocolController>::readGeometry(HokuyoGeometry& geometry, std::map<std::string, std::string>& versionInfo)
+{
+	(void) versionInfo;
+
+	std::map<std::string, std::string> parameters = getParameters();
+	if(parameters.empty()) return false;
+
+	geometry.setParameters(parameters);
+	return true;
+}
+
+}
+
+#endif // REGILO_HOKUYOSCIP2CONTROLLER_HPP
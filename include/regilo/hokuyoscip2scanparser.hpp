@@ -0,0 +1,152 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef REGILO_HOKUYOSCIP2SCANPARSER_HPP
+#define REGILO_HOKUYOSCIP2SCANPARSER_HPP
+
+#include <array>
+
+#include "scanparser.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The HokuyoScip2ScanParser class parses the output of the Hokuyo SCIP 2.0 `GD`/`GS` (and `MD`/`MS`) commands.
+ *
+ * The output is a status line, a time stamp line and the distances encoded in two or three characters per step.
+ * Every line ends with a checksum character that is validated while the line is decoded. The values of a line
+ * are stored when its checksum is verified, the values of a corrupt line are stored as records with
+ * CHECKSUM_ERROR_CODE, so the corrupt data never have to be parsed again.
+ */
+class HokuyoScip2ScanParser : public ScanParser
+{
+public:
+	static const int CHECKSUM_ERROR_CODE = -1; ///< The error code of records from a line with a wrong checksum.
+
+private:
+	enum class State { Status, Timestamp, Data, Failed };
+
+	struct Value
+	{
+		std::size_t step;
+		long distance;
+		bool corrupt;
+	};
+
+	static const std::size_t MAX_LINE_VALUES = 64;
+
+	std::size_t encoding = 3;
+	std::size_t fromStep = 0;
+	std::size_t stepIncrement = 1;
+	std::size_t validFromStep = 0;
+	std::size_t validToStep = 0;
+	std::size_t minDistance = 20;
+	double resolution = 0;
+	double startAngle = 0;
+	std::shared_ptr<const AngleTable> angleTable;
+
+	State state = State::Status;
+	char held = 0;
+	bool hasHeld = false;
+	unsigned int sum = 0;
+	char status[2];
+	std::size_t statusLength = 0;
+
+	long value = 0;
+	std::size_t valueLength = 0;
+	bool valueCorrupt = false;
+	std::array<Value, MAX_LINE_VALUES> lineValues;
+	std::size_t lineValueCount = 0;
+
+	std::size_t step = 0;
+	int lastId = 0;
+	bool tableAngles = true;
+	long timestamp = -1;
+	std::size_t corruptLines = 0;
+
+	void parseCharacter(char c);
+	void endLine(char checksum);
+	void addValue(const Value& value);
+
+protected:
+	virtual void reset() override;
+	virtual bool finish() override;
+
+public:
+	/**
+	 * @brief Compute the SCIP 2.0 checksum of a line.
+	 * @param begin The first character of the line.
+	 * @param end The character after the last character of the line (without the checksum).
+	 * @return The checksum character.
+	 */
+	static char checksum(const char *begin, const char *end);
+
+	/**
+	 * @brief Decode a SCIP 2.0 value (6 bits per character).
+	 * @param begin The first character of the value.
+	 * @param end The character after the last character of the value.
+	 * @return The decoded value.
+	 */
+	static long decode(const char *begin, const char *end);
+
+	/**
+	 * @brief Set the number of characters that encode one value.
+	 * @param encoding 3 for `GD`/`MD`, 2 for `GS`/`MS`.
+	 */
+	void setEncoding(std::size_t encoding);
+
+	/**
+	 * @brief Get the number of characters that encode one value.
+	 * @return 2 or 3.
+	 */
+	inline std::size_t getEncoding() const { return encoding; }
+
+	/**
+	 * @brief Set the scan parameters that the raw data correspond to.
+	 * @param fromStep The starting step.
+	 * @param stepIncrement The number of steps per value (the cluster count).
+	 * @param validFromStep The first step with a valid measurement.
+	 * @param validToStep The last step with a valid measurement.
+	 * @param minDistance The minimal valid distance (in millimeters), the smaller values are error codes.
+	 * @param resolution The angle between two steps (in radians).
+	 * @param startAngle The angle of the step zero (in radians).
+	 * @param angleTable The angles of the valid steps.
+	 */
+	void setParameters(std::size_t fromStep, std::size_t stepIncrement, std::size_t validFromStep, std::size_t validToStep,
+					   std::size_t minDistance, double resolution, double startAngle, std::shared_ptr<const AngleTable> angleTable);
+
+	virtual void parse(const char *begin, const char *end) override;
+
+	/**
+	 * @brief Get the time stamp of the last scan.
+	 * @return The time stamp (in milliseconds of the scanner clock) or -1 if it is unknown.
+	 */
+	inline long getTimestamp() const { return timestamp; }
+
+	/**
+	 * @brief Get the number of lines with a wrong checksum in the last scan.
+	 * @return The number of corrupt lines.
+	 */
+	inline std::size_t getCorruptLines() const { return corruptLines; }
+};
+
+}
+
+#endif // REGILO_HOKUYOSCIP2SCANPARSER_HPP
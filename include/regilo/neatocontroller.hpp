@@ -22,10 +22,14 @@
 #ifndef REGILO_NEATOCONTROLLER_HPP
 #define REGILO_NEATOCONTROLLER_HPP
 
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <mutex>
 
-#include <boost/algorithm/string.hpp>
-
+#include "neatoscanparser.hpp"
+#include "neatotelemetry.hpp"
+#include "odometry.hpp"
 #include "scancontroller.hpp"
 #include "serialcontroller.hpp"
 #include "socketcontroller.hpp"
@@ -75,6 +79,66 @@ public:
 	 */
 	virtual void setMotor(int left, int right, int speed) = 0;
 
+	/**
+	 * @brief Wait until the LDS is ready after it starts rotating (see setLdsRotation()).
+	 *
+	 * The scans are polled until the rotation speed of two consecutive scans is stable
+	 * and the ratio of records with an error drops below the threshold.
+	 *
+	 * @param timeout The maximum waiting time.
+	 * @param maxErrorRatio The maximum ratio of records with an error.
+	 * @param pollInterval The time between two polls.
+	 * @return True if the LDS is ready, false if the timeout expired.
+	 */
+	virtual bool waitForLds(std::chrono::milliseconds timeout, double maxErrorRatio = 0.8,
+							std::chrono::milliseconds pollInterval = std::chrono::milliseconds(100)) = 0;
+
+	/**
+	 * @brief Get the polling period of a sensor group.
+	 * @param sensor The sensor group.
+	 * @return The period (zero means that the group is not polled).
+	 */
+	virtual std::chrono::milliseconds getTelemetryPeriod(NeatoSensor sensor) const = 0;
+
+	/**
+	 * @brief Set the polling period of a sensor group.
+	 *
+	 * The sensor groups that are due are requested in the same write as every scan from the device
+	 * (see getScan()) or by pollTelemetry(), and their values are stored into getTelemetry().
+	 *
+	 * @param sensor The sensor group.
+	 * @param period The period (zero means that the group is not polled).
+	 */
+	virtual void setTelemetryPeriod(NeatoSensor sensor, std::chrono::milliseconds period) = 0;
+
+	/**
+	 * @brief Poll the sensor groups that are due as one batch (without a scan).
+	 *
+	 * It waits for the command in flight (e.g. a scan from another thread), so it can be run periodically
+	 * by CommandScheduler::schedulePeriodic() with the Telemetry priority.
+	 *
+	 * @return The number of polled sensor groups.
+	 */
+	virtual std::size_t pollTelemetry() = 0;
+
+	/**
+	 * @brief Get the last polled values of the sensors.
+	 * @return The telemetry.
+	 */
+	virtual const NeatoTelemetry& getTelemetry() const = 0;
+
+	/**
+	 * @brief Get the odometry that integrates the wheel positions from every `getmotors` poll.
+	 *
+	 * Set the polling period of NeatoSensor::Motors to turn it on. The motors are polled with every scan
+	 * (see setTelemetryPeriod()) and pollTelemetry() can be scheduled between the scans for a higher rate
+	 * (e.g. every 20 ms by CommandScheduler::schedulePeriodic()).
+	 * The pose at the scan time can be obtained by `getOdometry().getPose(data.steadyTime, pose)`.
+	 *
+	 * @return The odometry.
+	 */
+	virtual Odometry& getOdometry() = 0;
+
 	/**
 	 * @brief Get the current scheduler time.
 	 * @return "DayOfWeek HourOf24:Min:Sec" (example: "Sunday 13:57:09").
@@ -92,27 +156,86 @@ private:
 	bool testMode = false;
 	bool ldsRotation = false;
 
+	NeatoScanParser scanParser;
+
+	struct MotorRequest
+	{
+		int left;
+		int right;
+		int speed;
+	};
+
+	std::mutex linkMutex;
+	std::mutex motorMutex;
+	std::atomic<bool> motorCoalescing { false };
+	bool linkBusy = false;
+	bool motorPending = false;
+	MotorRequest pendingMotor;
+	std::size_t droppedMotorCommands = 0;
+
+	NeatoTelemetry telemetry;
+	Odometry odometry;
+	std::array<std::chrono::milliseconds, NEATO_SENSOR_COUNT> telemetryPeriods;
+	std::array<std::chrono::steady_clock::time_point, NEATO_SENSOR_COUNT> telemetryPolls;
+	std::array<CommandBuffer, NEATO_SENSOR_COUNT + 1> telemetryBatch;
+	std::array<NeatoSensor, NEATO_SENSOR_COUNT + 1> telemetryBatchSensors;
+	std::array<NeatoTelemetryParser, NEATO_SENSOR_COUNT + 1> telemetryParsers;
+	std::array<std::chrono::steady_clock::time_point, NEATO_SENSOR_COUNT + 1> telemetryReceived;
+	std::size_t telemetryBatchFirst = 0;
+	std::size_t telemetryBatchSize = 0;
+	std::chrono::steady_clock::time_point telemetryBatchTime;
+
+	std::size_t beginTelemetryBatch(std::size_t first);
+	void parseTelemetry(std::size_t index, const char *begin, const char *end);
+	void endTelemetryBatch();
+
+	void lockLink();
+	void unlockLink(bool sendMotor);
+
+	template<typename Function>
+	void exchangeOnLink(Function function);
+
 protected:
-	virtual inline std::string getScanCommand() const override { return CMD_GET_LDS_SCAN; }
-	virtual bool parseScanData(std::istream& in, ScanData& data) override;
+	virtual inline const CommandBuffer& getScanCommand() const override { return CMD_GET_LDS_SCAN; }
+	virtual inline ScanParser& getScanParser() override { return scanParser; }
+
+	virtual std::size_t beginScanBatch(const CommandBuffer*& commands) override;
+	virtual inline void parseScanBatch(std::size_t index, const char *begin, const char *end) override { parseTelemetry(index, begin, end); }
+	virtual inline void endScanBatch() override { endTelemetryBatch(); }
+
+	virtual inline void acquireLink() override { lockLink(); }
+	virtual inline void releaseLink(bool succeeded) override { unlockLink(succeeded); }
+
+	virtual void resume() override;
 
 public:
 	static std::string ON; ///< A string that represents the ON value.
 	static std::string OFF; ///< A string that represents the OFF value.
 	static std::string LDS_SCAN_HEADER; ///< A header of the LDS scan output.
 	static std::string LDS_SCAN_FOOTER; ///< A footer of the LDS scan output.
-
-	static std::string CMD_TEST_MODE; ///< A template for the `testmode` command.
-	static std::string CMD_SET_LDS_ROTATION; ///< A template for the `setldsrotation` command.
-	static std::string CMD_SET_MOTOR; ///< A template for the `setmotor` command.
-	static std::string CMD_GET_TIME; ///< A template for the `gettime` command.
-	static std::string CMD_GET_LDS_SCAN; ///< A template for the `getldsscan` command.
+	static const std::size_t LDS_SCAN_SIZE = 360; ///< The number of records in the LDS scan output.
+	static const std::shared_ptr<const AngleTable> LDS_ANGLE_TABLE; ///< The angles of the LDS scan records (one per degree).
+	static constexpr double LDS_MAX_SPEED_CHANGE = 0.05; ///< The maximum relative change of a stable rotation speed.
+	static constexpr double WHEEL_BASE = 248; ///< The distance between the wheels (in millimeters).
+
+	static constexpr CommandDescriptor<' ', command::Text> CMD_TEST_MODE{"testmode"}; ///< The `testmode` command.
+	static constexpr CommandDescriptor<' ', command::Text> CMD_SET_LDS_ROTATION{"setldsrotation"}; ///< The `setldsrotation` command.
+	static constexpr CommandDescriptor<' ', command::Int<>, command::Int<>, command::Int<>> CMD_SET_MOTOR{"setmotor"}; ///< The `setmotor` command.
+	static const CommandBuffer CMD_GET_TIME; ///< The `gettime` command.
+	static const CommandBuffer CMD_GET_LDS_SCAN; ///< The `getldsscan` command.
+	static const std::array<CommandBuffer, NEATO_SENSOR_COUNT> CMD_GET_SENSORS; ///< The commands of the sensor groups (in the NeatoSensor order).
 
 	/**
 	 * @brief Default constructor.
 	 */
 	NeatoController();
 
+	/**
+	 * @brief Constructor that uses a shared IO service (e.g. from ControllerManager).
+	 * @param ioService The IO service that has to outlive the controller.
+	 */
+	NeatoController(ba::io_service& ioService);
+
 	/**
 	 * @brief Constructor with a log file specified by a path.
 	 * @param logPath Path to the log file.
@@ -140,6 +263,45 @@ public:
 
 	virtual void setMotor(int left, int right, int speed) override;
 
+	virtual bool waitForLds(std::chrono::milliseconds timeout, double maxErrorRatio = 0.8,
+							std::chrono::milliseconds pollInterval = std::chrono::milliseconds(100)) override;
+
+	/**
+	 * @brief Get whether the setMotor() calls are coalesced.
+	 * @return True if only the latest pending `setmotor` is sent.
+	 */
+	inline bool getMotorCoalescing() const { return motorCoalescing; }
+
+	/**
+	 * @brief Turn on or off the latest-wins coalescing of setMotor().
+	 *
+	 * If it is on and any command of the controller is in flight (e.g. a scan, a telemetry poll or
+	 * another `setmotor`), setMotor() only stores the request and returns immediately. The call that holds
+	 * the link sends the latest stored request as soon as its own command finishes, the older requests
+	 * are dropped. So the robot never executes stale commands, regardless of the input rate.
+	 *
+	 * The methods of this class and getScan() are synchronized on the link. The asynchronous
+	 * requests and the generic sendCommand() of the protocol controller are not.
+	 *
+	 * @param motorCoalescing True for coalescing.
+	 */
+	inline void setMotorCoalescing(bool motorCoalescing) { this->motorCoalescing = motorCoalescing; }
+
+	/**
+	 * @brief Get the number of `setmotor` requests that were replaced by newer ones before they were sent.
+	 * @return The number of dropped requests.
+	 */
+	std::size_t getDroppedMotorCommands();
+
+	virtual inline std::chrono::milliseconds getTelemetryPeriod(NeatoSensor sensor) const override { return telemetryPeriods[std::size_t(sensor)]; }
+	virtual inline void setTelemetryPeriod(NeatoSensor sensor, std::chrono::milliseconds period) override { telemetryPeriods[std::size_t(sensor)] = period; }
+
+	virtual std::size_t pollTelemetry() override;
+
+	virtual inline const NeatoTelemetry& getTelemetry() const override { return telemetry; }
+
+	virtual inline Odometry& getOdometry() override { return odometry; }
+
 	virtual std::string getTime() override;
 };
 
@@ -162,111 +324,310 @@ template<typename ProtocolController>
 std::string NeatoController<ProtocolController>::LDS_SCAN_FOOTER = "ROTATION_SPEED,";
 
 template<typename ProtocolController>
-std::string NeatoController<ProtocolController>::CMD_TEST_MODE = "testmode %s";
+const std::size_t NeatoController<ProtocolController>::LDS_SCAN_SIZE;
 
 template<typename ProtocolController>
-std::string NeatoController<ProtocolController>::CMD_SET_LDS_ROTATION = "setldsrotation %s";
+const std::shared_ptr<const AngleTable> NeatoController<ProtocolController>::LDS_ANGLE_TABLE = std::make_shared<const AngleTable>(0, LDS_SCAN_SIZE, 1, M_PI / 180.0, 0);
 
 template<typename ProtocolController>
-std::string NeatoController<ProtocolController>::CMD_SET_MOTOR = "setmotor %d %d %d";
+constexpr double NeatoController<ProtocolController>::LDS_MAX_SPEED_CHANGE;
 
 template<typename ProtocolController>
-std::string NeatoController<ProtocolController>::CMD_GET_TIME = "gettime";
+constexpr double NeatoController<ProtocolController>::WHEEL_BASE;
 
 template<typename ProtocolController>
-std::string NeatoController<ProtocolController>::CMD_GET_LDS_SCAN = "getldsscan";
+constexpr CommandDescriptor<' ', command::Text> NeatoController<ProtocolController>::CMD_TEST_MODE;
+
+template<typename ProtocolController>
+constexpr CommandDescriptor<' ', command::Text> NeatoController<ProtocolController>::CMD_SET_LDS_ROTATION;
+
+template<typename ProtocolController>
+constexpr CommandDescriptor<' ', command::Int<>, command::Int<>, command::Int<>> NeatoController<ProtocolController>::CMD_SET_MOTOR;
+
+template<typename ProtocolController>
+const CommandBuffer NeatoController<ProtocolController>::CMD_GET_TIME("gettime");
+
+template<typename ProtocolController>
+const CommandBuffer NeatoController<ProtocolController>::CMD_GET_LDS_SCAN("getldsscan");
+
+template<typename ProtocolController>
+const std::array<CommandBuffer, NEATO_SENSOR_COUNT> NeatoController<ProtocolController>::CMD_GET_SENSORS = {{
+	CommandBuffer("getmotors"), CommandBuffer("getanalogsensors"), CommandBuffer("getdigitalsensors"), CommandBuffer("getcharger")
+}};
+
+template<typename ProtocolController>
+NeatoController<ProtocolController>::NeatoController() :
+	ScanController<ProtocolController>(),
+	scanParser(LDS_SCAN_HEADER, LDS_SCAN_FOOTER, LDS_ANGLE_TABLE),
+	odometry(WHEEL_BASE)
+{
+	this->RESPONSE_END = std::string(1, 0x1a);
+	telemetryPeriods.fill(std::chrono::milliseconds::zero());
+}
 
 template<typename ProtocolController>
-NeatoController<ProtocolController>::NeatoController() : ScanController<ProtocolController>()
+NeatoController<ProtocolController>::NeatoController(ba::io_service& ioService) :
+	ScanController<ProtocolController>(ioService),
+	scanParser(LDS_SCAN_HEADER, LDS_SCAN_FOOTER, LDS_ANGLE_TABLE),
+	odometry(WHEEL_BASE)
 {
 	this->RESPONSE_END = std::string(1, 0x1a);
+	telemetryPeriods.fill(std::chrono::milliseconds::zero());
 }
 
 template<typename ProtocolController>
-NeatoController<ProtocolController>::NeatoController(const std::string& logPath) : ScanController<ProtocolController>(logPath)
+NeatoController<ProtocolController>::NeatoController(const std::string& logPath) :
+	ScanController<ProtocolController>(logPath),
+	scanParser(LDS_SCAN_HEADER, LDS_SCAN_FOOTER, LDS_ANGLE_TABLE),
+	odometry(WHEEL_BASE)
 {
 	this->RESPONSE_END = std::string(1, 0x1a);
+	telemetryPeriods.fill(std::chrono::milliseconds::zero());
 }
 
 template<typename ProtocolController>
-NeatoController<ProtocolController>::NeatoController(std::iostream& logStream) : ScanController<ProtocolController>(logStream)
+NeatoController<ProtocolController>::NeatoController(std::iostream& logStream) :
+	ScanController<ProtocolController>(logStream),
+	scanParser(LDS_SCAN_HEADER, LDS_SCAN_FOOTER, LDS_ANGLE_TABLE),
+	odometry(WHEEL_BASE)
 {
 	this->RESPONSE_END = std::string(1, 0x1a);
+	telemetryPeriods.fill(std::chrono::milliseconds::zero());
+}
+
+template<typename ProtocolController>
+void NeatoController<ProtocolController>::lockLink()
+{
+	linkMutex.lock();
+
+	std::lock_guard<std::mutex> lock(motorMutex);
+	linkBusy = true;
+}
+
+template<typename ProtocolController>
+void NeatoController<ProtocolController>::unlockLink(bool sendMotor)
+{
+	std::unique_lock<std::mutex> link(linkMutex, std::adopt_lock);
+
+	while(true)
+	{
+		MotorRequest request;
+		{
+			std::lock_guard<std::mutex> lock(motorMutex);
+
+			// After a failure, the requests stored meanwhile cannot be sent either, the next setMotor() starts over
+			if(!sendMotor) motorPending = false;
+			if(!motorPending)
+			{
+				linkBusy = false;
+				return;
+			}
+
+			request = pendingMotor;
+			motorPending = false;
+		}
+
+		try
+		{
+			ProtocolController::template sendCommand<>(CMD_SET_MOTOR(request.left, request.right, request.speed));
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(motorMutex);
+			linkBusy = false;
+			motorPending = false;
+			throw;
+		}
+	}
+}
+
+template<typename ProtocolController>
+template<typename Function>
+void NeatoController<ProtocolController>::exchangeOnLink(Function function)
+{
+	lockLink();
+
+	try
+	{
+		function();
+	}
+	catch(...)
+	{
+		unlockLink(false);
+		throw;
+	}
+
+	unlockLink(true);
+}
+
+template<typename ProtocolController>
+void NeatoController<ProtocolController>::resume()
+{
+	// The link is already held by the call that reconnects
+	if(testMode) ProtocolController::template sendCommand<>(CMD_TEST_MODE(ON));
+	if(ldsRotation) ProtocolController::template sendCommand<>(CMD_SET_LDS_ROTATION(ON));
 }
 
 template<typename ProtocolController>
 void NeatoController<ProtocolController>::setTestMode(bool testMode)
 {
-	this->sendFormattedCommand(CMD_TEST_MODE, (testMode ? ON : OFF).c_str());
-	this->testMode = testMode;
+	exchangeOnLink([this, testMode] ()
+	{
+		ProtocolController::template sendCommand<>(CMD_TEST_MODE(testMode ? ON : OFF));
+		this->testMode = testMode;
+	});
 }
 
 template<typename ProtocolController>
 void NeatoController<ProtocolController>::setLdsRotation(bool ldsRotation)
 {
-	this->sendFormattedCommand(CMD_SET_LDS_ROTATION, (ldsRotation ? ON : OFF).c_str());
-	this->ldsRotation = ldsRotation;
+	exchangeOnLink([this, ldsRotation] ()
+	{
+		ProtocolController::template sendCommand<>(CMD_SET_LDS_ROTATION(ldsRotation ? ON : OFF));
+		this->ldsRotation = ldsRotation;
+	});
 }
 
 template<typename ProtocolController>
 void NeatoController<ProtocolController>::setMotor(int left, int right, int speed)
 {
-	this->sendFormattedCommand(CMD_SET_MOTOR, left, right, speed);
+	if(!motorCoalescing)
+	{
+		exchangeOnLink([this, left, right, speed] ()
+		{
+			ProtocolController::template sendCommand<>(CMD_SET_MOTOR(left, right, speed));
+		});
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(motorMutex);
+
+		if(motorPending) droppedMotorCommands++;
+		pendingMotor = MotorRequest { left, right, speed };
+		motorPending = true;
+
+		// The call that holds the link sends this request when its command finishes
+		if(linkBusy) return;
+		linkBusy = true;
+	}
+
+	linkMutex.lock();
+	unlockLink(true);
 }
 
 template<typename ProtocolController>
-bool NeatoController<ProtocolController>::parseScanData(std::istream& in, ScanData& data)
+bool NeatoController<ProtocolController>::waitForLds(std::chrono::milliseconds timeout, double maxErrorRatio, std::chrono::milliseconds pollInterval)
 {
-	int lastId = 0;
-	double M_PI_180 = M_PI / 180.0;
+	return this->waitForValidScans(timeout, maxErrorRatio, LDS_MAX_SPEED_CHANGE, pollInterval);
+}
 
-	std::string line;
-	std::getline(in, line);
-	boost::algorithm::trim(line);
+template<typename ProtocolController>
+std::size_t NeatoController<ProtocolController>::beginTelemetryBatch(std::size_t first)
+{
+	telemetryBatchTime = std::chrono::steady_clock::now();
+	telemetryBatchFirst = first;
+	telemetryBatchSize = first;
 
-	if(line == NeatoController<ProtocolController>::LDS_SCAN_HEADER)
+	for(std::size_t i = 0; i < NEATO_SENSOR_COUNT; i++)
 	{
-		while(true)
-		{
-			std::getline(in, line);
-			boost::algorithm::trim(line);
+		if(telemetryPeriods[i] == std::chrono::milliseconds::zero() || telemetryBatchTime - telemetryPolls[i] < telemetryPeriods[i]) continue;
 
-			if(boost::algorithm::starts_with(line, NeatoController<ProtocolController>::LDS_SCAN_FOOTER))
-			{
-				std::vector<std::string> values;
-				boost::algorithm::split(values, line, boost::algorithm::is_any_of(","));
-				data.rotationSpeed = std::stod(values.at(1));
+		NeatoSensor sensor = NeatoSensor(i);
 
-				break;
-			}
-			else
-			{
-				std::vector<std::string> values;
-				boost::algorithm::split(values, line, boost::algorithm::is_any_of(","));
+		telemetryBatch[telemetryBatchSize] = CMD_GET_SENSORS[i];
+		telemetryBatchSensors[telemetryBatchSize] = sensor;
+		telemetryParsers[telemetryBatchSize].begin(telemetry[sensor]);
+		telemetryBatchSize++;
+	}
 
-				int id = lastId++;
-				double angle = std::stod(values.at(0)) * M_PI_180;
-				double distance = std::stod(values.at(1));
-				int intensity = std::stoi(values.at(2));
-				int errorCode = std::stoi(values.at(3));
-				bool error = (errorCode != 0);
+	return telemetryBatchSize - first;
+}
 
-				if(error) distance = -1;
+template<typename ProtocolController>
+void NeatoController<ProtocolController>::parseTelemetry(std::size_t index, const char *begin, const char *end)
+{
+	telemetryParsers[index].parse(begin, end);
 
-				data.emplace_back(id, angle, distance, intensity, errorCode, error);
-			}
-		}
+	// The sensor values are valid when their own response is received, not when the batch is sent
+	telemetryReceived[index] = std::chrono::steady_clock::now();
+}
 
-		return true;
+template<typename ProtocolController>
+void NeatoController<ProtocolController>::endTelemetryBatch()
+{
+	long time = epoch<std::chrono::milliseconds>().count();
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	for(std::size_t i = telemetryBatchFirst; i < telemetryBatchSize; i++)
+	{
+		NeatoSensor sensor = telemetryBatchSensors[i];
+		telemetryPolls[std::size_t(sensor)] = telemetryBatchTime;
+
+		if(!telemetryParsers[i].end()) continue;
+
+		telemetry[sensor].time = time - std::chrono::duration_cast<std::chrono::milliseconds>(now - telemetryReceived[i]).count();
+		if(sensor == NeatoSensor::Motors)
+		{
+			odometry.update(telemetryReceived[i], telemetry.motors.leftWheelPosition, telemetry.motors.rightWheelPosition);
+		}
 	}
 
-	return false;
+	telemetryBatchSize = telemetryBatchFirst;
+}
+
+template<typename ProtocolController>
+std::size_t NeatoController<ProtocolController>::beginScanBatch(const CommandBuffer*& commands)
+{
+	telemetryBatch[0] = CMD_GET_LDS_SCAN;
+	commands = telemetryBatch.data();
+
+	return beginTelemetryBatch(1) + 1;
+}
+
+template<typename ProtocolController>
+std::size_t NeatoController<ProtocolController>::pollTelemetry()
+{
+	std::size_t count = 0;
+
+	exchangeOnLink([this, &count] ()
+	{
+		this->retryOnDisconnect([this, &count] ()
+		{
+			count = beginTelemetryBatch(0);
+			if(count == 0) return;
+
+			this->sendCommandsStreamed(telemetryBatch.data(), count, [this] (std::size_t index, const char *begin, const char *end)
+			{
+				parseTelemetry(index, begin, end);
+			});
+		});
+
+		endTelemetryBatch();
+	});
+
+	return count;
+}
+
+template<typename ProtocolController>
+std::size_t NeatoController<ProtocolController>::getDroppedMotorCommands()
+{
+	std::lock_guard<std::mutex> lock(motorMutex);
+	return droppedMotorCommands;
 }
 
 template<typename ProtocolController>
 std::string NeatoController<ProtocolController>::getTime()
 {
-	return this->sendCommand(CMD_GET_TIME);
+	std::string time;
+
+	exchangeOnLink([this, &time] ()
+	{
+		ProtocolController::template sendCommand<>(CMD_GET_TIME);
+		std::getline(this->deviceOutput, time, '\0');
+	});
+
+	return time;
 }
 
 }
@@ -0,0 +1,77 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_NEATOSCANPARSER_HPP
+#define REGILO_NEATOSCANPARSER_HPP
+
+#include <string>
+
+#include "scanparser.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The NeatoScanParser class parses the output of the Neato `getldsscan` command.
+ *
+ * The output is a header line, one line per record ("AngleInDegrees,DistInMM,Intensity,ErrorCodeHEX")
+ * and a footer line with the rotation speed. Every record is stored as soon as its line is complete.
+ */
+class NeatoScanParser : public ScanParser
+{
+private:
+	enum class State { Header, Records, Done, Failed };
+
+	static const std::size_t MAX_LINE_LENGTH = 128;
+
+	std::string header;
+	std::string footer;
+	std::shared_ptr<const AngleTable> angleTable;
+
+	State state = State::Header;
+	char line[MAX_LINE_LENGTH + 1];
+	std::size_t lineLength = 0;
+	bool lineOverflow = false;
+	int lastId = 0;
+	bool tableAngles = true;
+
+	void appendLine(const char *begin, const char *end);
+	void parseLine();
+	bool parseRecord(const char *begin);
+
+protected:
+	virtual void reset() override;
+	virtual bool finish() override;
+
+public:
+	/**
+	 * @brief Construct a parser.
+	 * @param header The header line of the scan output.
+	 * @param footer The beginning of the footer line of the scan output (followed by the rotation speed).
+	 * @param angleTable The angles of the records (one per degree).
+	 */
+	NeatoScanParser(const std::string& header, const std::string& footer, std::shared_ptr<const AngleTable> angleTable);
+
+	virtual void parse(const char *begin, const char *end) override;
+};
+
+}
+
+#endif // REGILO_NEATOSCANPARSER_HPP
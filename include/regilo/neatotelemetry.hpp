@@ -0,0 +1,220 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef REGILO_NEATOTELEMETRY_HPP
+#define REGILO_NEATOTELEMETRY_HPP
+
+#include <cstddef>
+
+namespace regilo {
+
+/**
+ * @brief The NeatoSensor enum lists the Neato sensor groups that can be polled.
+ */
+enum class NeatoSensor
+{
+	Motors, ///< The `getmotors` output.
+	AnalogSensors, ///< The `getanalogsensors` output.
+	DigitalSensors, ///< The `getdigitalsensors` output.
+	Charger ///< The `getcharger` output.
+};
+
+const std::size_t NEATO_SENSOR_COUNT = 4; ///< The number of the Neato sensor groups.
+
+/**
+ * @brief The NeatoSensorData struct is a base struct for typed values of one Neato sensor group.
+ */
+struct NeatoSensorData
+{
+	long time = -1; ///< The time of the last update (milliseconds since epoch, -1 if it was never updated).
+
+	/**
+	 * @brief Default destructor.
+	 */
+	virtual ~NeatoSensorData() = default;
+
+	/**
+	 * @brief Set a value that is specified by its label from the device output.
+	 * @param label The label (it is not null-terminated).
+	 * @param length The length of the label.
+	 * @param value The value.
+	 * @return True if the label is known.
+	 */
+	virtual bool setValue(const char *label, std::size_t length, double value) = 0;
+};
+
+/**
+ * @brief The NeatoMotors struct stores the output of the `getmotors` command.
+ */
+struct NeatoMotors : public NeatoSensorData
+{
+	int brushRpm = 0; ///< `Brush_RPM`
+	int brushCurrent = 0; ///< `Brush_mA`
+	int vacuumRpm = 0; ///< `Vacuum_RPM`
+	int vacuumCurrent = 0; ///< `Vacuum_mA`
+	int leftWheelRpm = 0; ///< `LeftWheel_RPM`
+	int leftWheelLoad = 0; ///< `LeftWheel_Load%`
+	int leftWheelPosition = 0; ///< `LeftWheel_PositionInMM`
+	int leftWheelSpeed = 0; ///< `LeftWheel_Speed`
+	int rightWheelRpm = 0; ///< `RightWheel_RPM`
+	int rightWheelLoad = 0; ///< `RightWheel_Load%`
+	int rightWheelPosition = 0; ///< `RightWheel_PositionInMM`
+	int rightWheelSpeed = 0; ///< `RightWheel_Speed`
+	int sideBrushCurrent = 0; ///< `SideBrush_mA`
+
+	virtual bool setValue(const char *label, std::size_t length, double value) override;
+};
+
+/**
+ * @brief The NeatoAnalogSensors struct stores the output of the `getanalogsensors` command.
+ */
+struct NeatoAnalogSensors : public NeatoSensorData
+{
+	int wallDistance = 0; ///< `WallSensorInMM`
+	int batteryVoltage = 0; ///< `BatteryVoltageInmV`
+	int leftDropDistance = 0; ///< `LeftDropInMM`
+	int rightDropDistance = 0; ///< `RightDropInMM`
+	int leftMagSensor = 0; ///< `LeftMagSensor`
+	int rightMagSensor = 0; ///< `RightMagSensor`
+	int uiButtonVoltage = 0; ///< `UIButtonInmV`
+	int vacuumCurrent = 0; ///< `VacuumCurrentInmA`
+	int chargeVoltage = 0; ///< `ChargeVoltInmV`
+	int batteryTemperature0 = 0; ///< `BatteryTemp0InC`
+	int batteryTemperature1 = 0; ///< `BatteryTemp1InC`
+	int current = 0; ///< `CurrentInmA`
+	int sideBrushCurrent = 0; ///< `SideBrushCurrentInmA`
+	int voltageReference = 0; ///< `VoltageReferenceInmV`
+	int accelerationX = 0; ///< `AccelXInmG`
+	int accelerationY = 0; ///< `AccelYInmG`
+	int accelerationZ = 0; ///< `AccelZInmG`
+
+	virtual bool setValue(const char *label, std::size_t length, double value) override;
+};
+
+/**
+ * @brief The NeatoDigitalSensors struct stores the output of the `getdigitalsensors` command.
+ */
+struct NeatoDigitalSensors : public NeatoSensorData
+{
+	bool dcJackConnected = false; ///< `SNSR_DC_JACK_CONNECT`
+	bool dustbinIn = false; ///< `SNSR_DUSTBIN_IS_IN`
+	bool leftWheelExtended = false; ///< `SNSR_LEFT_WHEEL_EXTENDED`
+	bool rightWheelExtended = false; ///< `SNSR_RIGHT_WHEEL_EXTENDED`
+	bool leftSideBumper = false; ///< `LSIDEBIT`
+	bool leftFrontBumper = false; ///< `LFRONTBIT`
+	bool rightSideBumper = false; ///< `RSIDEBIT`
+	bool rightFrontBumper = false; ///< `RFRONTBIT`
+
+	virtual bool setValue(const char *label, std::size_t length, double value) override;
+};
+
+/**
+ * @brief The NeatoCharger struct stores the output of the `getcharger` command.
+ */
+struct NeatoCharger : public NeatoSensorData
+{
+	int fuelPercent = 0; ///< `FuelPercent`
+	bool batteryOverTemperature = false; ///< `BatteryOverTemp`
+	bool chargingActive = false; ///< `ChargingActive`
+	bool chargingEnabled = false; ///< `ChargingEnabled`
+	bool confidentOnFuel = false; ///< `ConfidentOnFuel`
+	bool onReservedFuel = false; ///< `OnReservedFuel`
+	bool emptyFuel = false; ///< `EmptyFuel`
+	bool batteryFailure = false; ///< `BatteryFailure`
+	bool externalPowerPresent = false; ///< `ExtPwrPresent`
+	double batteryVoltage = 0; ///< `VBattV`
+	double externalVoltage = 0; ///< `VExtV`
+	int chargerCapacity = 0; ///< `Charger_mAH`
+
+	virtual bool setValue(const char *label, std::size_t length, double value) override;
+};
+
+/**
+ * @brief The NeatoTelemetry struct stores the last values of all the Neato sensor groups.
+ */
+struct NeatoTelemetry
+{
+	NeatoMotors motors; ///< The motors.
+	NeatoAnalogSensors analogSensors; ///< The analog sensors.
+	NeatoDigitalSensors digitalSensors; ///< The digital sensors.
+	NeatoCharger charger; ///< The charger.
+
+	/**
+	 * @brief Get the data of a sensor group.
+	 * @param sensor The sensor group.
+	 * @return The data of the group.
+	 */
+	NeatoSensorData& operator[](NeatoSensor sensor);
+
+	/**
+	 * @brief Get the data of a sensor group.
+	 * @param sensor The sensor group.
+	 * @return The data of the group.
+	 */
+	const NeatoSensorData& operator[](NeatoSensor sensor) const;
+};
+
+/**
+ * @brief The NeatoTelemetryParser class parses the "Label,Value" outputs of the Neato sensor commands.
+ *
+ * The output is a header line and one line per value. The label is the first field of a line and the value
+ * is the last one, so outputs with a unit column are supported too. The parser consumes the response
+ * in arbitrary parts and it does not allocate any memory.
+ */
+class NeatoTelemetryParser
+{
+private:
+	static const std::size_t MAX_LINE_LENGTH = 128;
+
+	NeatoSensorData *data = nullptr;
+
+	bool header = true;
+	char line[MAX_LINE_LENGTH + 1];
+	std::size_t lineLength = 0;
+	bool lineOverflow = false;
+	std::size_t values = 0;
+
+	void appendLine(const char *begin, const char *end);
+	void parseLine();
+
+public:
+	/**
+	 * @brief Start parsing of a new response.
+	 * @param data Output for the parsed values.
+	 */
+	void begin(NeatoSensorData& data);
+
+	/**
+	 * @brief Parse the next part of the response.
+	 * @param begin The first character of the part.
+	 * @param end The character after the last character of the part.
+	 */
+	void parse(const char *begin, const char *end);
+
+	/**
+	 * @brief End parsing of the current response.
+	 * @return True if at least one known value was parsed.
+	 */
+	bool end();
+};
+
+}
+
+#endif // REGILO_NEATOTELEMETRY_HPP
@@ -0,0 +1,113 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef REGILO_ODOMETRY_HPP
+#define REGILO_ODOMETRY_HPP
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "pose.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The Odometry class integrates the pose of a differential drive robot from its wheel positions.
+ *
+ * The poses are stored on the monotonic (steady clock) timeline in a ring buffer, so the pose at any recent time
+ * (e.g. ScanData::steadyTime) can be interpolated. All methods are thread-safe, so the wheel positions can be
+ * updated from another thread than the one that reads the poses.
+ */
+class Odometry
+{
+public:
+	typedef std::chrono::steady_clock::time_point TimePoint; ///< A point on the monotonic timeline.
+
+private:
+	struct Sample
+	{
+		TimePoint time;
+		Pose pose;
+	};
+
+	mutable std::mutex mutex;
+
+	double wheelBase;
+	std::vector<Sample> samples;
+	std::size_t first = 0;
+	std::size_t count = 0;
+
+	bool initialized = false;
+	double lastLeft = 0;
+	double lastRight = 0;
+	Pose pose;
+
+	const Sample& getSample(std::size_t index) const;
+
+public:
+	/**
+	 * @brief Construct the odometry.
+	 * @param wheelBase The distance between the wheels (in millimeters).
+	 * @param historySize The number of stored poses.
+	 */
+	Odometry(double wheelBase, std::size_t historySize = 256);
+
+	/**
+	 * @brief Get the distance between the wheels.
+	 * @return The wheel base (in millimeters).
+	 */
+	inline double getWheelBase() const { return wheelBase; }
+
+	/**
+	 * @brief Integrate new wheel positions.
+	 *
+	 * The first update only stores the positions. The samples have to be added in the time order.
+	 *
+	 * @param time The time of the positions.
+	 * @param left The position of the left wheel (in millimeters).
+	 * @param right The position of the right wheel (in millimeters).
+	 */
+	void update(TimePoint time, double left, double right);
+
+	/**
+	 * @brief Reset the pose and forget the history (the next update only stores the positions).
+	 * @param pose The new pose.
+	 */
+	void reset(const Pose& pose = Pose());
+
+	/**
+	 * @brief Get the latest pose.
+	 * @return The pose (theta is not normalized, so it keeps the number of turns).
+	 */
+	Pose getPose() const;
+
+	/**
+	 * @brief Interpolate the pose at a time.
+	 * @param time The time.
+	 * @param pose Output for the pose.
+	 * @return False if the time is not covered by the history.
+	 */
+	bool getPose(TimePoint time, Pose& pose) const;
+};
+
+}
+
+#endif // REGILO_ODOMETRY_HPP
@@ -0,0 +1,60 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_POSE_HPP
+#define REGILO_POSE_HPP
+
+#include <iosfwd>
+
+namespace regilo {
+
+/**
+ * @brief The Pose class represents a position and heading in the plane.
+ */
+class Pose
+{
+public:
+	double x = 0; ///< The x coordinate (in millimeters).
+	double y = 0; ///< The y coordinate (in millimeters).
+	double theta = 0; ///< The heading (in radians).
+
+	/**
+	 * @brief Default constructor (the origin).
+	 */
+	Pose() = default;
+
+	/**
+	 * @brief Construct a Pose from all attributes.
+	 * @param x The x coordinate (in millimeters).
+	 * @param y The y coordinate (in millimeters).
+	 * @param theta The heading (in radians).
+	 */
+	Pose(double x, double y, double theta);
+
+	/**
+	 * @brief Output the pose as a string.
+	 */
+	friend std::ostream& operator<<(std::ostream& out, const Pose& pose);
+};
+
+}
+
+#endif // REGILO_POSE_HPP
@@ -0,0 +1,64 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_RECONNECTPOLICY_HPP
+#define REGILO_RECONNECTPOLICY_HPP
+
+#include <chrono>
+#include <cstddef>
+
+namespace regilo {
+
+/**
+ * @brief The ReconnectPolicy struct describes how a controller reconnects after the connection is lost.
+ *
+ * The n-th attempt (starting from zero) waits for initialDelay * multiplier^n, at most maxDelay.
+ */
+struct ReconnectPolicy
+{
+	std::size_t maxAttempts = 0; ///< The maximum number of attempts (zero disables reconnecting).
+	std::chrono::milliseconds initialDelay = std::chrono::milliseconds(100); ///< The delay before the first attempt.
+	std::chrono::milliseconds maxDelay = std::chrono::milliseconds(5000); ///< The maximum delay between two attempts.
+	double multiplier = 2; ///< The factor that the delay grows with after every failed attempt.
+
+	/**
+	 * @brief Get the delay before an attempt.
+	 * @param attempt The attempt number (starting from zero).
+	 * @return The delay.
+	 */
+	std::chrono::milliseconds getDelay(std::size_t attempt) const;
+};
+
+/**
+ * @brief The ConnectionStats struct contains the reconnect metrics of a controller.
+ */
+struct ConnectionStats
+{
+	std::size_t disconnects = 0; ///< The number of detected connection losses.
+	std::size_t reconnects = 0; ///< The number of successful reconnects.
+	std::size_t attempts = 0; ///< The number of all reconnect attempts.
+	std::chrono::milliseconds lastDowntime = std::chrono::milliseconds::zero(); ///< The duration of the last outage.
+	std::chrono::milliseconds totalDowntime = std::chrono::milliseconds::zero(); ///< The duration of all outages.
+};
+
+}
+
+#endif // REGILO_RECONNECTPOLICY_HPP
@@ -22,8 +22,15 @@
 #ifndef REGILO_SCANCONTROLLER_HPP
 #define REGILO_SCANCONTROLLER_HPP
 
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
 #include "controller.hpp"
 #include "scandata.hpp"
+#include "scandatapool.hpp"
+#include "scanparser.hpp"
 #include "utils.hpp"
 
 namespace regilo {
@@ -34,6 +41,8 @@ namespace regilo {
 class IScanController : public virtual IController
 {
 public:
+	typedef std::function<void(const boost::system::error_code& error)> ScanHandler; ///< A handler of an asynchronous scan.
+
 	/**
 	 * @brief Default destructor.
 	 */
@@ -45,6 +54,39 @@ public:
 	 * @return ScanData
 	 */
 	virtual ScanData getScan(bool fromDevice = true) = 0;
+
+	/**
+	 * @brief Get a scan from the device and store it into existing ScanData (its capacity is reused).
+	 * @param data Output for the scanned data (it is reset at first).
+	 * @param fromDevice Specify if you want to get a scan from the device (true) or log (false). Default: true.
+	 */
+	virtual void getScan(ScanData& data, bool fromDevice = true) = 0;
+
+	/**
+	 * @brief Get a scan from the device into recycled ScanData from a pool.
+	 * @param pool The pool that provides the ScanData.
+	 * @param fromDevice Specify if you want to get a scan from the device (true) or log (false). Default: true.
+	 * @return ScanData that returns to the pool after the last std::shared_ptr is released.
+	 */
+	virtual std::shared_ptr<ScanData> getScan(ScanDataPool& pool, bool fromDevice = true) = 0;
+
+	/**
+	 * @brief Get a scan from the device without blocking.
+	 *
+	 * The handler is called from a thread that runs the controller's io_service (see ControllerManager)
+	 * after the scan is parsed. No other command can be sent to the device until then.
+	 *
+	 * @param data Output for the scanned data (it is reset at first and it has to be valid until the handler is called).
+	 * @param handler The function that is called when the scan is finished or failed.
+	 */
+	virtual void asyncGetScan(ScanData& data, const ScanHandler& handler) = 0;
+
+	/**
+	 * @brief Set a function that is called with parts of a scan while the scan is being received.
+	 * @param sectorSize The number of records in a part (zero disables the callback).
+	 * @param callback The function that is called with the finished records.
+	 */
+	virtual void setSectorCallback(std::size_t sectorSize, const ScanParser::SectorCallback& callback) = 0;
 };
 
 /**
@@ -53,24 +95,109 @@ public:
 template<typename ProtocolController>
 class ScanController : public virtual IScanController, public ProtocolController
 {
+public:
+	/**
+	 * @brief The DuplicatePolicy enum specifies what happens with a scan that repeats the previous response.
+	 */
+	enum class DuplicatePolicy
+	{
+		Ignore, ///< Duplicates are not detected.
+		Flag, ///< Duplicates are parsed and flagged (ScanData::duplicate) and they keep the previous scan id.
+		Suppress ///< Duplicates are flagged but not parsed (the ScanData stays empty).
+	};
+
+private:
+	std::string lastResponse;
+	std::string response;
+	bool matching = false;
+
+	ScanData readinessData;
+
+	void beginResponse();
+	void parseResponse(ScanParser& parser, const char *begin, const char *end);
+	bool endResponse(ScanParser& parser);
+	void finishScan(ScanData& data, bool duplicate);
+
 protected:
 	std::size_t lastScanId = 0; ///< A scan id (starting from zero) that is used for new scans.
+	std::chrono::steady_clock::time_point responseStartTime; ///< The time when the first part of the last scan response was received.
+	std::size_t responseTailSize = 0; ///< The size of the last scan response without its first part.
+	std::chrono::steady_clock::time_point responseSentTime; ///< The time when the last scan command was sent.
+	std::size_t responseSize = 0; ///< The size of the last scan response.
 
 	/**
-	 * @brief Get a string that can be used for getting a scan.
+	 * @brief Get a command that can be used for getting a scan.
 	 * @return A command for getting a scan.
 	 */
-	virtual std::string getScanCommand() const = 0;
+	virtual const CommandBuffer& getScanCommand() const = 0;
+
+	/**
+	 * @brief Get a parser of the raw scan data (it is fed while the response is being received).
+	 * @return The scan parser.
+	 */
+	virtual ScanParser& getScanParser() = 0;
 
 	/**
-	 * @brief Parse the raw scan data.
-	 * @param in The input stream that stores the raw scan data.
-	 * @param data Output for the scanned data.
-	 * @return True if the parsing ends without an error.
+	 * @brief Begin a batch of commands that is sent in a single write when a scan is requested from the device.
+	 *
+	 * The first command of the batch has to be the scan command. The other commands are answered after the scan
+	 * and their responses are passed to parseScanBatch(). By default, the batch contains only the scan command.
+	 *
+	 * @param commands Output for the pointer to the first command of the batch.
+	 * @return The number of commands in the batch.
 	 */
-	virtual bool parseScanData(std::istream& in, ScanData& data) = 0;
+	virtual std::size_t beginScanBatch(const CommandBuffer*& commands);
+
+	/**
+	 * @brief Parse the next part of a response to an extra command of the scan batch.
+	 * @param index The position of the command in the batch (greater than zero).
+	 * @param begin The first character of the part.
+	 * @param end The character after the last character of the part.
+	 */
+	virtual inline void parseScanBatch(std::size_t index, const char *begin, const char *end) { (void) index; (void) begin; (void) end; }
+
+	/**
+	 * @brief End the scan batch after all its responses are received.
+	 */
+	virtual inline void endScanBatch() {}
+
+	/**
+	 * @brief Acquire the link before a scan is requested from the device (by default, nothing is done).
+	 *
+	 * It is always paired with releaseLink(), so the subclasses can serialize their commands with the scans.
+	 */
+	virtual inline void acquireLink() {}
+
+	/**
+	 * @brief Release the link after a scan is received from the device (by default, nothing is done).
+	 * @param succeeded False if the scan request failed (the exception is rethrown after this call).
+	 */
+	virtual inline void releaseLink(bool succeeded) { (void) succeeded; }
+
+	/**
+	 * @brief End a scan that was received from the device (e.g. correct its time).
+	 *
+	 * It is called after the scan is parsed and ScanData::time and ScanData::steadyTime are set
+	 * to the received time. By default, nothing is done.
+	 *
+	 * @param data The scan data.
+	 */
+	virtual inline void endDeviceScan(ScanData& data) { (void) data; }
+
+	/**
+	 * @brief Poll scans from the device until they are valid or the timeout expires.
+	 * @param timeout The maximum waiting time.
+	 * @param maxErrorRatio The maximum ratio of records with an error in a valid scan.
+	 * @param maxSpeedChange The maximum relative change of the rotation speed between two valid scans
+	 *                       (a negative value disables the rotation check).
+	 * @param pollInterval The time between two polls.
+	 * @return True if a valid scan was received in time.
+	 */
+	bool waitForValidScans(std::chrono::milliseconds timeout, double maxErrorRatio, double maxSpeedChange, std::chrono::milliseconds pollInterval);
 
 public:
+	DuplicatePolicy duplicatePolicy = DuplicatePolicy::Ignore; ///< The handling of scans that repeat the previous response.
+
 	using ProtocolController::ProtocolController;
 
 	/**
@@ -79,35 +206,243 @@ public:
 	virtual ~ScanController() = default;
 
 	virtual ScanData getScan(bool fromDevice = true) override final;
+	virtual void getScan(ScanData& data, bool fromDevice = true) override final;
+	virtual std::shared_ptr<ScanData> getScan(ScanDataPool& pool, bool fromDevice = true) override final;
+	virtual void asyncGetScan(ScanData& data, const ScanHandler& handler) override final;
+
+	virtual inline void setSectorCallback(std::size_t sectorSize, const ScanParser::SectorCallback& callback) override final
+	{
+		getScanParser().setSectorCallback(sectorSize, callback);
+	}
 };
 
+template<typename ProtocolController>
+void ScanController<ProtocolController>::beginResponse()
+{
+	response.clear();
+	matching = (duplicatePolicy != DuplicatePolicy::Ignore && !lastResponse.empty());
+
+	responseStartTime = std::chrono::steady_clock::time_point();
+	responseTailSize = 0;
+	responseSentTime = std::chrono::steady_clock::now();
+	responseSize = 0;
+}
+
+template<typename ProtocolController>
+void ScanController<ProtocolController>::parseResponse(ScanParser& parser, const char *begin, const char *end)
+{
+	if(responseStartTime == std::chrono::steady_clock::time_point()) responseStartTime = std::chrono::steady_clock::now();
+	else responseTailSize += end - begin;
+	responseSize += end - begin;
+
+	if(duplicatePolicy == DuplicatePolicy::Ignore)
+	{
+		parser.parse(begin, end);
+		return;
+	}
+
+	std::size_t offset = response.size();
+	std::size_t size = end - begin;
+	response.append(begin, end);
+
+	if(matching)
+	{
+		if(offset + size <= lastResponse.size() && std::memcmp(lastResponse.data() + offset, begin, size) == 0)
+		{
+			// While the response repeats the previous one, the suppressed parsing is postponed
+			if(duplicatePolicy == DuplicatePolicy::Flag) parser.parse(begin, end);
+			return;
+		}
+
+		matching = false;
+		if(duplicatePolicy == DuplicatePolicy::Suppress) parser.parse(response.data(), response.data() + offset);
+	}
+
+	parser.parse(begin, end);
+}
+
+template<typename ProtocolController>
+bool ScanController<ProtocolController>::endResponse(ScanParser& parser)
+{
+	if(duplicatePolicy == DuplicatePolicy::Ignore) return false;
+
+	bool duplicate = (matching && response.size() == lastResponse.size());
+	if(matching && !duplicate && duplicatePolicy == DuplicatePolicy::Suppress)
+	{
+		// A shorter response that only starts like the previous one
+		parser.parse(response.data(), response.data() + response.size());
+	}
+
+	lastResponse.swap(response);
+
+	return duplicate;
+}
+
+template<typename ProtocolController>
+void ScanController<ProtocolController>::finishScan(ScanData& data, bool duplicate)
+{
+	if(duplicate)
+	{
+		data.duplicate = true;
+		if(lastScanId != 0) data.scanId = lastScanId - 1;
+	}
+	else if(!data.empty()) data.scanId = lastScanId++;
+}
+
+template<typename ProtocolController>
+bool ScanController<ProtocolController>::waitForValidScans(std::chrono::milliseconds timeout, double maxErrorRatio, double maxSpeedChange,
+														   std::chrono::milliseconds pollInterval)
+{
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+	double lastSpeed = -1;
+
+	while(true)
+	{
+		getScan(readinessData);
+
+		std::size_t errors = 0;
+		for(const ScanRecord& record : readinessData)
+		{
+			if(record.error) errors++;
+		}
+
+		bool ready = (!readinessData.empty() && errors <= maxErrorRatio * readinessData.size());
+		if(maxSpeedChange >= 0)
+		{
+			double speed = readinessData.rotationSpeed;
+			ready = ready && speed > 0 && lastSpeed > 0 && std::abs(speed - lastSpeed) <= maxSpeedChange * lastSpeed;
+			lastSpeed = speed;
+		}
+
+		if(ready) return true;
+		if(std::chrono::steady_clock::now() + pollInterval > deadline) return false;
+
+		std::this_thread::sleep_for(pollInterval);
+	}
+}
+
+template<typename ProtocolController>
+std::size_t ScanController<ProtocolController>::beginScanBatch(const CommandBuffer*& commands)
+{
+	commands = &getScanCommand();
+	return 1;
+}
+
 template<typename ProtocolController>
 ScanData ScanController<ProtocolController>::getScan(bool fromDevice)
 {
 	ScanData data;
+	getScan(data, fromDevice);
+
+	return data;
+}
+
+template<typename ProtocolController>
+void ScanController<ProtocolController>::getScan(ScanData& data, bool fromDevice)
+{
+	ScanParser& parser = getScanParser();
 
 	if(fromDevice)
 	{
-		ProtocolController::template sendCommand<>(getScanCommand());
-		data.time = epoch<std::chrono::milliseconds>().count();
+		acquireLink();
+
+		try
+		{
+			this->retryOnDisconnect([this, &data, &parser] ()
+			{
+				data.reset();
+				parser.begin(data);
+				beginResponse();
+
+				const CommandBuffer *commands;
+				std::size_t count = beginScanBatch(commands);
+
+				this->sendCommandsStreamed(commands, count, [this, &data, &parser] (std::size_t index, const char *begin, const char *end)
+				{
+					if(index == 0)
+					{
+						parseResponse(parser, begin, end);
 
-		parseScanData(this->deviceOutput, data);
+						// The scan is received with its last part, the other responses of the batch must not delay it
+						data.time = epoch<std::chrono::milliseconds>().count();
+						data.steadyTime = std::chrono::steady_clock::now();
+					}
+					else parseScanBatch(index, begin, end);
+				});
+
+				endScanBatch();
+			});
+		}
+		catch(...)
+		{
+			releaseLink(false);
+			throw;
+		}
+
+		releaseLink(true);
 	}
 	else
 	{
-		std::istringstream response(this->log->readCommand(getScanCommand()));
+		data.reset();
+		parser.begin(data);
+		beginResponse();
+
+		std::string logResponse = this->log->readCommand(getScanCommand().str());
 		if(std::shared_ptr<const ITimedLog> timedLog = std::dynamic_pointer_cast<const ITimedLog>(this->getLog()))
 		{
 			data.time = timedLog->getLastCommandTimeAs<std::chrono::milliseconds>().count();
 		}
 
-		parseScanData(response, data);
+		parseResponse(parser, logResponse.data(), logResponse.data() + logResponse.size());
 	}
-	if(!data.empty()) data.scanId = lastScanId++;
+
+	bool duplicate = endResponse(parser);
+	parser.end();
+
+	if(fromDevice) endDeviceScan(data);
+	finishScan(data, duplicate);
+}
+
+template<typename ProtocolController>
+std::shared_ptr<ScanData> ScanController<ProtocolController>::getScan(ScanDataPool& pool, bool fromDevice)
+{
+	std::shared_ptr<ScanData> data = pool.acquire();
+	getScan(*data, fromDevice);
 
 	return data;
 }
 
+template<typename ProtocolController>
+void ScanController<ProtocolController>::asyncGetScan(ScanData& data, const ScanHandler& handler)
+{
+	data.reset();
+
+	ScanParser& parser = getScanParser();
+	parser.begin(data);
+	beginResponse();
+
+	auto consume = [this, &parser] (const char *begin, const char *end)
+	{
+		parseResponse(parser, begin, end);
+	};
+
+	this->asyncSendCommandStreamed(getScanCommand(), consume, [this, &data, &parser, handler] (const boost::system::error_code& error)
+	{
+		bool duplicate = (!error && endResponse(parser));
+		parser.end();
+
+		if(!error)
+		{
+			data.time = epoch<std::chrono::milliseconds>().count();
+			data.steadyTime = std::chrono::steady_clock::now();
+			endDeviceScan(data);
+			finishScan(data, duplicate);
+		}
+
+		handler(error);
+	});
+}
+
 }
 
 #endif // REGILO_SCANCONTROLLER_HPP
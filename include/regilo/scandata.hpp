@@ -22,8 +22,11 @@
 #ifndef REGILO_SCANDATA_HPP
 #define REGILO_SCANDATA_HPP
 
+#include <chrono>
+#include <memory>
 #include <vector>
 
+#include "angletable.hpp"
 #include "scanrecord.hpp"
 
 namespace regilo {
@@ -36,7 +39,10 @@ class ScanData : public std::vector<ScanRecord>
 public:
 	std::size_t scanId = std::size_t(-1); ///< The scan id (starting from zero).
 	double rotationSpeed = -1; ///< The rotation speed (in Hz).
-	long time; ///< The scan time (milliseconds since epoch).
+	long time = 0; ///< The scan time (milliseconds since epoch).
+	std::chrono::steady_clock::time_point steadyTime; ///< The time when the scan was received or captured if the device clock is synchronized (on the monotonic timeline).
+	bool duplicate = false; ///< True if the device returned the same response as for the previous scan.
+	std::shared_ptr<const AngleTable> angleTable; ///< The precomputed angles of the records (indexed by the record id) or empty std::shared_ptr.
 
 	/**
 	 * @brief Default constructor.
@@ -50,6 +56,22 @@ public:
 	 */
 	ScanData(std::size_t scanId, double rotationSpeed);
 
+	/**
+	 * @brief Remove all records and reset the scan attributes (the capacity is kept).
+	 */
+	void reset();
+
+	/**
+	 * @brief Get the capture time of a record.
+	 *
+	 * The records are captured evenly during one revolution (see rotationSpeed) and the last record
+	 * is captured at steadyTime. If the rotation speed is unknown, steadyTime is returned.
+	 *
+	 * @param index The position of the record in the data.
+	 * @return The interpolated capture time (on the monotonic timeline).
+	 */
+	std::chrono::steady_clock::time_point getRecordTime(std::size_t index) const;
+
 	/**
 	 * @brief Output the data as a string.
 	 */
@@ -0,0 +1,77 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_SCANDATAPOOL_HPP
+#define REGILO_SCANDATAPOOL_HPP
+
+#include <memory>
+
+#include "scandata.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The ScanDataPool class is used to recycle ScanData buffers.
+ *
+ * The pool hands out ScanData as std::shared_ptr that can be shared between more consumers.
+ * When the last consumer releases it, the data (with its capacity) returns to the pool.
+ * The control blocks of the pointers are recycled as well, so a steady state does not allocate any memory.
+ * The pool can be destroyed before the handed out data.
+ */
+class ScanDataPool
+{
+private:
+	class Storage;
+	class Deleter;
+	template<typename T> class BlockAllocator;
+
+	std::shared_ptr<Storage> storage;
+
+public:
+	/**
+	 * @brief Construct a pool.
+	 * @param size The number of ScanData that are created in advance.
+	 * @param recordCapacity The number of records that is reserved in every ScanData.
+	 */
+	ScanDataPool(std::size_t size = 0, std::size_t recordCapacity = 0);
+
+	/**
+	 * @brief Get a free ScanData from the pool (a new one is created if there is no free data).
+	 * @return Empty ScanData that returns to the pool after the last std::shared_ptr is released.
+	 */
+	std::shared_ptr<ScanData> acquire();
+
+	/**
+	 * @brief Get the number of all ScanData that were created by the pool.
+	 * @return The number of free and used ScanData.
+	 */
+	std::size_t getSize() const;
+
+	/**
+	 * @brief Get the number of ScanData that are ready in the pool.
+	 * @return The number of free ScanData.
+	 */
+	std::size_t getFreeCount() const;
+};
+
+}
+
+#endif // REGILO_SCANDATAPOOL_HPP
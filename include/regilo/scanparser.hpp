@@ -0,0 +1,122 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_SCANPARSER_HPP
+#define REGILO_SCANPARSER_HPP
+
+#include <functional>
+
+#include "scandata.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The ScanParser class is a base class for resumable parsers of raw scan data.
+ *
+ * The parser consumes the response in arbitrary parts (as they arrive from the device)
+ * and stores every finished record into ScanData immediately.
+ */
+class ScanParser
+{
+public:
+	/**
+	 * @brief A function that is called with a finished part of the scan (records [from; to)).
+	 */
+	typedef std::function<void(const ScanData& data, std::size_t from, std::size_t to)> SectorCallback;
+
+private:
+	std::size_t sectorSize = 0;
+	std::size_t sectorFrom = 0;
+	SectorCallback sectorCallback;
+
+protected:
+	ScanData *data = nullptr; ///< The data that are being parsed.
+
+	/**
+	 * @brief Add a finished record to the data (and notify the sector callback if a sector is complete).
+	 */
+	template<typename... Args>
+	void addRecord(Args&& ... args);
+
+	/**
+	 * @brief Notify the sector callback about the remaining records.
+	 */
+	void flushSector();
+
+	/**
+	 * @brief Reset the protocol-specific state before a new scan.
+	 */
+	virtual void reset() = 0;
+
+	/**
+	 * @brief Finish the protocol-specific parsing.
+	 * @return True if the parsing ends without an error.
+	 */
+	virtual bool finish() = 0;
+
+public:
+	/**
+	 * @brief Default destructor.
+	 */
+	virtual ~ScanParser() = default;
+
+	/**
+	 * @brief Start parsing of a new scan.
+	 * @param data Output for the scanned data.
+	 */
+	void begin(ScanData& data);
+
+	/**
+	 * @brief Parse the next part of the raw scan data.
+	 * @param begin The first character of the part.
+	 * @param end The character after the last character of the part.
+	 */
+	virtual void parse(const char *begin, const char *end) = 0;
+
+	/**
+	 * @brief End parsing of the current scan.
+	 * @return True if the parsing ends without an error.
+	 */
+	bool end();
+
+	/**
+	 * @brief Set a function that is called whenever sectorSize records are finished (and with the rest at the end).
+	 * @param sectorSize The number of records in a sector (zero disables the callback).
+	 * @param callback The function that is called with the finished sector.
+	 */
+	void setSectorCallback(std::size_t sectorSize, const SectorCallback& callback);
+};
+
+template<typename... Args>
+void ScanParser::addRecord(Args&& ... args)
+{
+	data->emplace_back(std::forward<Args>(args)...);
+
+	if(sectorSize != 0 && data->size() - sectorFrom >= sectorSize)
+	{
+		sectorCallback(*data, sectorFrom, data->size());
+		sectorFrom = data->size();
+	}
+}
+
+}
+
+#endif // REGILO_SCANPARSER_HPP
@@ -0,0 +1,111 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_SCANPOLLSCHEDULER_HPP
+#define REGILO_SCANPOLLSCHEDULER_HPP
+
+#include <chrono>
+#include <vector>
+
+#include "scancontroller.hpp"
+
+namespace regilo {
+
+/**
+ * @brief The ScanPollScheduler class polls a rotating scanner just after every rotation is completed.
+ *
+ * The Neato LDS returns the last completed rotation for every `getldsscan`, so polling faster than the rotation
+ * returns the same scan again and polling slower makes the data older. The scheduler takes the period from
+ * the measured rotation speed (ScanData::rotationSpeed) and locks its phase to the rotation: when a poll returns
+ * the same rotation again, it is repeated after a short step and the step is halved, so the following polls
+ * are issued at most about one step (down to the precision) after the rotation ends.
+ */
+class ScanPollScheduler
+{
+private:
+	IScanController& controller;
+
+	double rotationSpeed;
+	std::chrono::steady_clock::duration precision;
+	std::chrono::steady_clock::duration step;
+	std::chrono::steady_clock::time_point nextPoll;
+	bool lastPollStale = false;
+
+	std::size_t polls = 0;
+	std::size_t stalePolls = 0;
+
+	std::vector<double> lastDistances;
+	std::vector<int> lastIntensities;
+
+	bool isNewRotation(const ScanData& data);
+
+public:
+	/**
+	 * @brief Create a scheduler for a controller.
+	 * @param controller The controller that is polled.
+	 * @param rotationSpeed The expected rotation speed (in Hz) that is used until it is measured.
+	 * @param precision The smallest step of the phase search.
+	 */
+	ScanPollScheduler(IScanController& controller, double rotationSpeed = 5, std::chrono::milliseconds precision = std::chrono::milliseconds(5));
+
+	/**
+	 * @brief Wait for the next rotation and get its scan from the device.
+	 * @param data Output for the scanned data.
+	 */
+	void getScan(ScanData& data);
+
+	/**
+	 * @brief Update the schedule with a finished poll (getScan() calls it for every poll).
+	 * @param pollTime The time when the scan command was sent.
+	 * @param newRotation True if the poll returned a rotation that was not returned before.
+	 * @param rotationSpeed The measured rotation speed (in Hz) or a non-positive value if it is unknown.
+	 * @return The time of the next poll.
+	 */
+	std::chrono::steady_clock::time_point update(std::chrono::steady_clock::time_point pollTime, bool newRotation, double rotationSpeed);
+
+	/**
+	 * @brief Get the current rotation period.
+	 * @return The period that follows from the last measured rotation speed.
+	 */
+	std::chrono::steady_clock::duration getPeriod() const;
+
+	/**
+	 * @brief Get the time of the next poll.
+	 * @return The time point (getScan() sleeps until it).
+	 */
+	inline std::chrono::steady_clock::time_point getNextPollTime() const { return nextPoll; }
+
+	/**
+	 * @brief Get the number of all polls.
+	 * @return The number of polls.
+	 */
+	inline std::size_t getPolls() const { return polls; }
+
+	/**
+	 * @brief Get the number of polls that returned an already returned rotation.
+	 * @return The number of stale polls.
+	 */
+	inline std::size_t getStalePolls() const { return stalePolls; }
+};
+
+}
+
+#endif // REGILO_SCANPOLLSCHEDULER_HPP
@@ -36,6 +36,9 @@ class SerialController : public StreamController<ba::serial_port>
 private:
 	std::string endpoint;
 
+protected:
+	virtual void reopen() override;
+
 public:
 	using StreamController::StreamController;
 
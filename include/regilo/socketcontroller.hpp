@@ -35,6 +35,12 @@ namespace bai = ba::ip;
  */
 class SocketController : public StreamController<bai::tcp::socket>
 {
+private:
+	bai::tcp::endpoint remoteEndpoint;
+
+protected:
+	virtual void reopen() override;
+
 public:
 	using StreamController::StreamController;
 
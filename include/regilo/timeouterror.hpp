@@ -0,0 +1,46 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REGILO_TIMEOUTERROR_HPP
+#define REGILO_TIMEOUTERROR_HPP
+
+#include <boost/system/system_error.hpp>
+
+namespace regilo {
+
+/**
+ * @brief The TimeoutError class is thrown when a command does not finish before its deadline.
+ *
+ * The error code is always boost::asio::error::timed_out, so it can be caught either as TimeoutError
+ * or as a generic boost::system::system_error.
+ */
+class TimeoutError : public boost::system::system_error
+{
+public:
+	/**
+	 * @brief Default constructor.
+	 */
+	TimeoutError();
+};
+
+}
+
+#endif // REGILO_TIMEOUTERROR_HPP
@@ -0,0 +1,45 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/angletable.hpp"
+
+#include <cmath>
+
+namespace regilo {
+
+AngleTable::AngleTable(std::size_t firstStep, std::size_t size, std::size_t stepIncrement, double resolution, double startAngle)
+{
+	angles.reserve(size);
+	cosines.reserve(size);
+	sines.reserve(size);
+
+	for(std::size_t i = 0; i < size; i++)
+	{
+		std::size_t step = firstStep + i * stepIncrement;
+		double angle = step * resolution + startAngle;
+
+		angles.push_back(angle);
+		cosines.push_back(std::cos(angle));
+		sines.push_back(std::sin(angle));
+	}
+}
+
+}
@@ -0,0 +1,265 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/cartesian.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace regilo {
+
+namespace {
+
+const std::size_t BLOCK_SIZE = 64;
+
+// The records are gathered block by block into contiguous arrays, so they are transformed by whole vectors
+struct Block
+{
+	double distances[BLOCK_SIZE];
+	double cosines[BLOCK_SIZE];
+	double sines[BLOCK_SIZE];
+	double poseX[BLOCK_SIZE];
+	double poseY[BLOCK_SIZE];
+	double poseCos[BLOCK_SIZE];
+	double poseSin[BLOCK_SIZE];
+	double x[BLOCK_SIZE];
+	double y[BLOCK_SIZE];
+
+	inline PolarArrays getInput() const { return PolarArrays { distances, cosines, sines, poseX, poseY, poseCos, poseSin }; }
+};
+
+bool isTableValid(const ScanData& data)
+{
+	if(!data.angleTable) return false;
+
+	std::size_t tableSize = data.angleTable->size();
+	for(const ScanRecord& record : data)
+	{
+		if(record.id < 0 || std::size_t(record.id) >= tableSize) return false;
+	}
+
+	return true;
+}
+
+void gatherRecords(const ScanRecord *records, std::size_t size, const AngleTable *table, Block& block)
+{
+	for(std::size_t i = 0; i < size; i++)
+	{
+		const ScanRecord& record = records[i];
+
+		block.distances[i] = record.distance;
+		block.cosines[i] = (table != nullptr ? table->cosines[record.id] : std::cos(record.angle));
+		block.sines[i] = (table != nullptr ? table->sines[record.id] : std::sin(record.angle));
+	}
+}
+
+// The records with an error are skipped in a separate pass, so the transformation has no branches
+template<typename T>
+std::size_t compactRecords(const ScanRecord *records, std::size_t size, const Block& block, Point<T> *points)
+{
+	std::size_t count = 0;
+	for(std::size_t i = 0; i < size; i++)
+	{
+		if(!records[i].error) points[count++] = Point<T>(T(block.x[i]), T(block.y[i]));
+	}
+
+	return count;
+}
+
+template<typename T>
+std::size_t convertRecords(const ScanRecord *records, std::size_t size, const AngleTable *table, Point<T> *points, const Pose& pose)
+{
+	Block block;
+	std::fill_n(block.poseX, BLOCK_SIZE, pose.x);
+	std::fill_n(block.poseY, BLOCK_SIZE, pose.y);
+	std::fill_n(block.poseCos, BLOCK_SIZE, std::cos(pose.theta));
+	std::fill_n(block.poseSin, BLOCK_SIZE, std::sin(pose.theta));
+
+	std::size_t count = 0;
+	for(std::size_t first = 0; first < size; first += BLOCK_SIZE)
+	{
+		std::size_t blockSize = std::min(BLOCK_SIZE, size - first);
+
+		gatherRecords(records + first, blockSize, table, block);
+		transformPolar(block.getInput(), blockSize, block.x, block.y);
+		count += compactRecords(records + first, blockSize, block, points + count);
+	}
+
+	return count;
+}
+
+template<typename T>
+std::size_t deskewRecords(const ScanRecord *records, std::size_t size, const AngleTable *table, Point<T> *points,
+						  const Pose& startPose, const Pose& endPose)
+{
+	double step = (size > 1 ? 1.0 / (size - 1) : 0);
+	double stepX = (endPose.x - startPose.x) * step;
+	double stepY = (endPose.y - startPose.y) * step;
+	double stepCos = std::cos((endPose.theta - startPose.theta) * step);
+	double stepSin = std::sin((endPose.theta - startPose.theta) * step);
+
+	// The heading of the records is rotated incrementally
+	double poseCos = std::cos(startPose.theta);
+	double poseSin = std::sin(startPose.theta);
+
+	Block block;
+	std::size_t count = 0;
+	for(std::size_t first = 0; first < size; first += BLOCK_SIZE)
+	{
+		std::size_t blockSize = std::min(BLOCK_SIZE, size - first);
+
+		for(std::size_t i = 0; i < blockSize; i++)
+		{
+			block.poseX[i] = startPose.x + (first + i) * stepX;
+			block.poseY[i] = startPose.y + (first + i) * stepY;
+			block.poseCos[i] = poseCos;
+			block.poseSin[i] = poseSin;
+
+			double nextCos = poseCos * stepCos - poseSin * stepSin;
+			poseSin = poseSin * stepCos + poseCos * stepSin;
+			poseCos = nextCos;
+		}
+
+		gatherRecords(records + first, blockSize, table, block);
+		transformPolar(block.getInput(), blockSize, block.x, block.y);
+		count += compactRecords(records + first, blockSize, block, points + count);
+	}
+
+	return count;
+}
+
+template<typename T>
+std::size_t convert(const ScanData& data, std::vector<Point<T>>& points, const Pose& pose)
+{
+	points.resize(data.size());
+
+	const AngleTable *table = (isTableValid(data) ? data.angleTable.get() : nullptr);
+	std::size_t count = convertRecords(data.data(), data.size(), table, points.data(), pose);
+
+	points.resize(count);
+	return count;
+}
+
+template<typename T>
+std::size_t deskew(const ScanData& data, std::vector<Point<T>>& points, const Pose& startPose, const Pose& endPose)
+{
+	points.resize(data.size());
+
+	const AngleTable *table = (isTableValid(data) ? data.angleTable.get() : nullptr);
+	std::size_t count = deskewRecords(data.data(), data.size(), table, points.data(), startPose, endPose);
+
+	points.resize(count);
+	return count;
+}
+
+}
+
+void transformPolar(const PolarArrays& input, std::size_t size, double *x, double *y, bool vectorized)
+{
+	std::size_t i = 0;
+
+#if defined(__AVX__)
+	for(; vectorized && i + 4 <= size; i += 4)
+	{
+		__m256d distance = _mm256_loadu_pd(input.distances + i);
+		__m256d cosine = _mm256_loadu_pd(input.cosines + i);
+		__m256d sine = _mm256_loadu_pd(input.sines + i);
+		__m256d poseCos = _mm256_loadu_pd(input.poseCos + i);
+		__m256d poseSin = _mm256_loadu_pd(input.poseSin + i);
+
+		__m256d rotatedCos = _mm256_sub_pd(_mm256_mul_pd(poseCos, cosine), _mm256_mul_pd(poseSin, sine));
+		__m256d rotatedSin = _mm256_add_pd(_mm256_mul_pd(poseSin, cosine), _mm256_mul_pd(poseCos, sine));
+
+		_mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_loadu_pd(input.poseX + i), _mm256_mul_pd(distance, rotatedCos)));
+		_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(input.poseY + i), _mm256_mul_pd(distance, rotatedSin)));
+	}
+#elif defined(__SSE2__)
+	for(; vectorized && i + 2 <= size; i += 2)
+	{
+		__m128d distance = _mm_loadu_pd(input.distances + i);
+		__m128d cosine = _mm_loadu_pd(input.cosines + i);
+		__m128d sine = _mm_loadu_pd(input.sines + i);
+		__m128d poseCos = _mm_loadu_pd(input.poseCos + i);
+		__m128d poseSin = _mm_loadu_pd(input.poseSin + i);
+
+		__m128d rotatedCos = _mm_sub_pd(_mm_mul_pd(poseCos, cosine), _mm_mul_pd(poseSin, sine));
+		__m128d rotatedSin = _mm_add_pd(_mm_mul_pd(poseSin, cosine), _mm_mul_pd(poseCos, sine));
+
+		_mm_storeu_pd(x + i, _mm_add_pd(_mm_loadu_pd(input.poseX + i), _mm_mul_pd(distance, rotatedCos)));
+		_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(input.poseY + i), _mm_mul_pd(distance, rotatedSin)));
+	}
+#else
+	(void) vectorized;
+#endif
+
+	// The scalar fallback and the rest of the last vector
+	for(; i < size; i++)
+	{
+		double rotatedCos = input.poseCos[i] * input.cosines[i] - input.poseSin[i] * input.sines[i];
+		double rotatedSin = input.poseSin[i] * input.cosines[i] + input.poseCos[i] * input.sines[i];
+
+		x[i] = input.poseX[i] + input.distances[i] * rotatedCos;
+		y[i] = input.poseY[i] + input.distances[i] * rotatedSin;
+	}
+}
+
+std::size_t toCartesian(const ScanData& data, std::vector<Point<float>>& points, const Pose& pose)
+{
+	return convert(data, points, pose);
+}
+
+std::size_t toCartesian(const ScanData& data, std::vector<Point<double>>& points, const Pose& pose)
+{
+	return convert(data, points, pose);
+}
+
+std::size_t toCartesian(const ScanData& data, std::vector<Point<float>>& points, const Pose& startPose, const Pose& endPose)
+{
+	return deskew(data, points, startPose, endPose);
+}
+
+std::size_t toCartesian(const ScanData& data, std::vector<Point<double>>& points, const Pose& startPose, const Pose& endPose)
+{
+	return deskew(data, points, startPose, endPose);
+}
+
+bool getScanMotion(const ScanData& data, const Odometry& odometry, Pose& startPose, Pose& endPose)
+{
+	if(data.empty()) return false;
+
+	return odometry.getPose(data.getRecordTime(0), startPose) && odometry.getPose(data.getRecordTime(data.size() - 1), endPose);
+}
+
+Pose getScanStartPose(const ScanData& data, const Pose& endPose, const Pose& velocity)
+{
+	if(data.size() < 2) return endPose;
+
+	double duration = std::chrono::duration<double>(data.getRecordTime(data.size() - 1) - data.getRecordTime(0)).count();
+	return Pose(endPose.x - velocity.x * duration, endPose.y - velocity.y * duration, endPose.theta - velocity.theta * duration);
+}
+
+}
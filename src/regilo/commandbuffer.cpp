@@ -0,0 +1,86 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/commandbuffer.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace regilo {
+
+const std::size_t CommandBuffer::CAPACITY;
+
+CommandBuffer::CommandBuffer(const std::string& command)
+{
+	append(command);
+}
+
+void CommandBuffer::reserve(std::size_t count)
+{
+	if(count > CAPACITY - length) throw std::length_error("The command does not fit into the buffer.");
+}
+
+void CommandBuffer::append(char c)
+{
+	reserve(1);
+	buffer[length++] = c;
+}
+
+void CommandBuffer::append(const char *text, std::size_t count)
+{
+	reserve(count);
+	std::memcpy(buffer + length, text, count);
+	length += count;
+}
+
+void CommandBuffer::append(const std::string& text)
+{
+	append(text.data(), text.size());
+}
+
+void CommandBuffer::append(long value, std::size_t width)
+{
+	char digits[24];
+	std::size_t count = 0;
+
+	unsigned long absValue = (value < 0 ? 0UL - static_cast<unsigned long>(value) : static_cast<unsigned long>(value));
+	do
+	{
+		digits[count++] = char('0' + absValue % 10);
+		absValue /= 10;
+	}
+	while(absValue != 0);
+
+	std::size_t zeros = (width > count ? width - count : 0);
+	reserve((value < 0 ? 1 : 0) + zeros + count);
+
+	if(value < 0) buffer[length++] = '-';
+	for(std::size_t i = 0; i < zeros; i++) buffer[length++] = '0';
+	while(count != 0) buffer[length++] = digits[--count];
+}
+
+std::ostream& operator<<(std::ostream& out, const CommandBuffer& command)
+{
+	return out.write(command.data(), command.size());
+}
+
+}
@@ -0,0 +1,279 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/commandscheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace regilo {
+
+const std::size_t CommandScheduler::PRIORITY_COUNT;
+
+CommandScheduler::CommandScheduler(std::chrono::milliseconds agingInterval) :
+	agingInterval(agingInterval)
+{
+	worker = std::thread([this] ()
+	{
+		run();
+	});
+}
+
+CommandScheduler::~CommandScheduler()
+{
+	stop();
+}
+
+void CommandScheduler::enqueue(Priority priority, std::function<void()>&& task, const std::string& key)
+{
+	std::size_t level = std::size_t(priority);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(!running) throw std::logic_error("The scheduler is stopped.");
+
+		// The commands with the same key are superseded in this and all lower priorities
+		for(std::size_t replaced = level; replaced < PRIORITY_COUNT && !key.empty(); replaced++)
+		{
+			std::deque<Job>& queue = queues[replaced];
+			std::size_t size = queue.size();
+			queue.erase(std::remove_if(queue.begin(), queue.end(), [&key] (const Job& job) { return job.key == key; }), queue.end());
+
+			stats.replaced += size - queue.size();
+			stats.depth[replaced] = queue.size();
+		}
+
+		queues[level].push_back(Job { std::move(task), std::chrono::steady_clock::now(), nextSequence++, key, 0 });
+
+		stats.depth[level] = queues[level].size();
+		stats.maxDepth[level] = std::max(stats.maxDepth[level], stats.depth[level]);
+	}
+
+	condition.notify_one();
+}
+
+std::size_t CommandScheduler::schedulePeriodic(Priority priority, std::chrono::milliseconds period, std::function<void()> command)
+{
+	if(period <= std::chrono::milliseconds::zero()) throw std::invalid_argument("The period has to be positive.");
+
+	std::size_t id;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(!running) throw std::logic_error("The scheduler is stopped.");
+
+		// The worker cannot propagate the exceptions, so they are counted
+		std::function<void()> task = [this, command] ()
+		{
+			try
+			{
+				command();
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stats.failed++;
+			}
+		};
+
+		id = nextPeriodicId++;
+		periodics.push_back(Periodic { id, std::size_t(priority), period, std::move(task), std::chrono::steady_clock::now() });
+	}
+
+	condition.notify_one();
+
+	return id;
+}
+
+bool CommandScheduler::cancelPeriodic(std::size_t id)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto periodic = std::find_if(periodics.begin(), periodics.end(), [id] (const Periodic& periodic) { return periodic.id == id; });
+	if(periodic == periodics.end()) return false;
+
+	std::deque<Job>& queue = queues[periodic->level];
+	queue.erase(std::remove_if(queue.begin(), queue.end(), [id] (const Job& job) { return job.periodicId == id; }), queue.end());
+	stats.depth[periodic->level] = queue.size();
+
+	periodics.erase(periodic);
+
+	return true;
+}
+
+std::chrono::steady_clock::time_point CommandScheduler::queuePeriodic(std::chrono::steady_clock::time_point now)
+{
+	std::chrono::steady_clock::time_point nextDue = std::chrono::steady_clock::time_point::max();
+
+	for(Periodic& periodic : periodics)
+	{
+		if(periodic.due <= now)
+		{
+			std::deque<Job>& queue = queues[periodic.level];
+			std::size_t id = periodic.id;
+
+			if(std::any_of(queue.begin(), queue.end(), [id] (const Job& job) { return job.periodicId == id; })) stats.skipped++;
+			else
+			{
+				queue.push_back(Job { periodic.task, now, nextSequence++, std::string(), id });
+
+				stats.depth[periodic.level] = queue.size();
+				stats.maxDepth[periodic.level] = std::max(stats.maxDepth[periodic.level], stats.depth[periodic.level]);
+			}
+
+			// The runs missed while a command was in flight are skipped, not run in a burst
+			std::size_t missed = std::size_t((now - periodic.due) / periodic.period);
+			stats.skipped += missed;
+			periodic.due += (missed + 1) * periodic.period;
+		}
+
+		nextDue = std::min(nextDue, periodic.due);
+	}
+
+	return nextDue;
+}
+
+bool CommandScheduler::hasJobs() const
+{
+	for(const std::deque<Job>& queue : queues)
+	{
+		if(!queue.empty()) return true;
+	}
+
+	return false;
+}
+
+std::size_t CommandScheduler::selectQueue(std::chrono::steady_clock::time_point now, bool& promoted) const
+{
+	std::size_t selected = PRIORITY_COUNT;
+	std::size_t selectedPriority = PRIORITY_COUNT;
+
+	for(std::size_t level = 0; level < PRIORITY_COUNT; level++)
+	{
+		if(queues[level].empty()) continue;
+
+		const Job& job = queues[level].front();
+
+		// Every agingInterval of waiting raises the priority by one level
+		std::size_t raise = 0;
+		if(agingInterval > std::chrono::steady_clock::duration::zero())
+		{
+			raise = std::min<std::size_t>(level, std::size_t((now - job.queued) / agingInterval));
+		}
+
+		std::size_t priority = level - raise;
+		if(priority < selectedPriority || (priority == selectedPriority && job.sequence < queues[selected].front().sequence))
+		{
+			selected = level;
+			selectedPriority = priority;
+		}
+	}
+
+	// The job is promoted only if it overtakes a command with a higher priority
+	promoted = false;
+	for(std::size_t level = 0; level < selected && selected != PRIORITY_COUNT; level++)
+	{
+		if(!queues[level].empty()) promoted = true;
+	}
+
+	return selected;
+}
+
+void CommandScheduler::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while(true)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::time_point nextDue = queuePeriodic(now);
+
+		if(!running) break;
+
+		if(!hasJobs())
+		{
+			// Woken up by a new command, a new periodic command, or stop()
+			if(periodics.empty()) condition.wait(lock);
+			else condition.wait_until(lock, nextDue);
+
+			continue;
+		}
+
+		bool promoted = false;
+		std::size_t level = selectQueue(now, promoted);
+
+		Job job = std::move(queues[level].front());
+		queues[level].pop_front();
+
+		stats.depth[level] = queues[level].size();
+		stats.executed[level]++;
+		if(promoted) stats.promoted++;
+
+		std::chrono::microseconds wait = std::chrono::duration_cast<std::chrono::microseconds>(now - job.queued);
+		if(wait > stats.maxWait) stats.maxWait = wait;
+
+		lock.unlock();
+		job.task();
+		lock.lock();
+	}
+}
+
+std::size_t CommandScheduler::getQueueDepth() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::size_t depth = 0;
+	for(const std::deque<Job>& queue : queues)
+	{
+		depth += queue.size();
+	}
+
+	return depth;
+}
+
+CommandScheduler::Stats CommandScheduler::getStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+void CommandScheduler::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(!running && !worker.joinable()) return;
+
+		running = false;
+	}
+
+	condition.notify_one();
+	if(worker.joinable()) worker.join();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	periodics.clear();
+
+	for(std::size_t level = 0; level < PRIORITY_COUNT; level++)
+	{
+		queues[level].clear();
+		stats.depth[level] = 0;
+	}
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/controllermanager.hpp"
+
+#include <algorithm>
+
+namespace regilo {
+
+ControllerManager::ControllerManager(std::size_t threadCount) :
+	work(new ba::io_service::work(ioService))
+{
+	if(threadCount == 0) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	threads.reserve(threadCount);
+	for(std::size_t i = 0; i < threadCount; i++)
+	{
+		threads.emplace_back([this] ()
+		{
+			ioService.run();
+		});
+	}
+}
+
+ControllerManager::~ControllerManager()
+{
+	stop();
+}
+
+void ControllerManager::stop()
+{
+	work.reset();
+	ioService.stop();
+
+	for(std::thread& thread : threads)
+	{
+		if(thread.joinable()) thread.join();
+	}
+
+	threads.clear();
+}
+
+}
@@ -0,0 +1,67 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/delimitermatcher.hpp"
+
+#include <cstring>
+
+namespace regilo {
+
+DelimiterMatcher::DelimiterMatcher(const std::string& delimiter)
+{
+	setDelimiter(delimiter);
+}
+
+void DelimiterMatcher::setDelimiter(const std::string& delimiter)
+{
+	this->delimiter = delimiter;
+	matched = 0;
+
+	// failure[i] is the length of the longest proper prefix of delimiter[0..i] that is also its suffix
+	failure.assign(delimiter.size(), 0);
+	for(std::size_t i = 1, length = 0; i < delimiter.size(); i++)
+	{
+		while(length != 0 && delimiter[i] != delimiter[length]) length = failure[length - 1];
+		if(delimiter[i] == delimiter[length]) length++;
+
+		failure[i] = length;
+	}
+}
+
+const char* DelimiterMatcher::find(const char *begin, const char *end)
+{
+	if(delimiter.empty()) return begin;
+
+	while(begin != end)
+	{
+		if(matched == 0)
+		{
+			begin = static_cast<const char*>(std::memchr(begin, delimiter.front(), end - begin));
+			if(begin == nullptr) return nullptr;
+		}
+
+		if(match(*begin++)) return begin;
+	}
+
+	return nullptr;
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "regilo/hokuyoautocluster.hpp"
+
+#include <stdexcept>
+
+namespace regilo {
+
+constexpr double HokuyoAutoCluster::SMOOTHING;
+const std::size_t HokuyoAutoCluster::MAX_CLUSTER_COUNT;
+
+void HokuyoAutoCluster::setTargetScanRate(double targetScanRate)
+{
+	if(targetScanRate < 0) throw std::invalid_argument("Invalid targetScanRate argument.");
+	this->targetScanRate = targetScanRate;
+}
+
+void HokuyoAutoCluster::addTransfer(std::size_t bytes, std::chrono::steady_clock::duration duration)
+{
+	double seconds = std::chrono::duration<double>(duration).count();
+	if(bytes == 0 || seconds <= 0) return;
+
+	double measured = bytes / seconds;
+	throughput = (throughput == 0 ? measured : (1 - SMOOTHING) * throughput + SMOOTHING * measured);
+}
+
+std::size_t HokuyoAutoCluster::getClusterCount(std::size_t stepCount, std::size_t encoding, std::size_t lineOverhead,
+											   std::size_t headerSize) const
+{
+	if(throughput == 0 || !isEnabled()) return 0;
+
+	double maxBytes = throughput / targetScanRate;
+	for(std::size_t clusterCount = 1; clusterCount < MAX_CLUSTER_COUNT; clusterCount++)
+	{
+		std::size_t characters = (stepCount + clusterCount - 1) / clusterCount * encoding;
+		std::size_t lines = (characters + 63) / 64;
+
+		if(headerSize + characters + lines * lineOverhead <= maxBytes) return clusterCount;
+	}
+
+	return MAX_CLUSTER_COUNT;
+}
+
+}
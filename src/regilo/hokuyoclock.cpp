@@ -0,0 +1,174 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "regilo/hokuyoclock.hpp"
+
+#include <algorithm>
+
+namespace regilo {
+
+constexpr double HokuyoClock::MAX_DRIFT;
+
+HokuyoClock::HokuyoClock(std::size_t historySize) :
+	historySize(std::max<std::size_t>(historySize, 1))
+{
+}
+
+long long HokuyoClock::unwrap(long deviceTime) const
+{
+	if(!hasDeviceTime) return deviceTime;
+
+	// The nearest time with the same 24 bits
+	long long diff = (deviceTime - lastDeviceTime) % DEVICE_TIME_RANGE;
+	if(diff < 0) diff += DEVICE_TIME_RANGE;
+	if(diff >= DEVICE_TIME_RANGE / 2) diff -= DEVICE_TIME_RANGE;
+
+	return lastDeviceTime + diff;
+}
+
+void HokuyoClock::updateDeviceTime(long long deviceTime)
+{
+	if(!hasDeviceTime || deviceTime > lastDeviceTime) lastDeviceTime = deviceTime;
+	hasDeviceTime = true;
+}
+
+double HokuyoClock::predict(long long deviceTime) const
+{
+	return offset + correction + (1 + drift) * (deviceTime / 1000.0);
+}
+
+void HokuyoClock::fit()
+{
+	double deviceMean = 0, hostMean = 0;
+	for(const Sample& sample : samples)
+	{
+		deviceMean += sample.deviceTime;
+		hostMean += sample.hostTime;
+	}
+
+	deviceMean /= samples.size();
+	hostMean /= samples.size();
+
+	double covariance = 0, variance = 0;
+	for(const Sample& sample : samples)
+	{
+		double deviceDiff = sample.deviceTime - deviceMean;
+		covariance += deviceDiff * (sample.hostTime - hostMean);
+		variance += deviceDiff * deviceDiff;
+	}
+
+	// At least one second is needed for a meaningful drift
+	drift = (variance >= 1 ? std::min(std::max(covariance / variance - 1, -MAX_DRIFT), MAX_DRIFT) : 0);
+	offset = hostMean - (1 + drift) * deviceMean;
+	updateCorrection();
+}
+
+void HokuyoClock::updateCorrection()
+{
+	// The recent scan that is received the earliest relative to its time stamp bounds the offset from above
+	correction = 0;
+	for(const Sample& scan : scans)
+	{
+		correction = std::min(correction, scan.hostTime - (offset + (1 + drift) * scan.deviceTime));
+	}
+}
+
+void HokuyoClock::reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	samples.clear();
+	scans.clear();
+	hasDeviceTime = false;
+	lastDeviceTime = 0;
+	offset = 0;
+	drift = 0;
+	correction = 0;
+	accuracy = std::chrono::steady_clock::duration::max();
+}
+
+void HokuyoClock::addRoundTrip(TimePoint sent, TimePoint received, long deviceTime)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(samples.empty()) origin = sent;
+
+	long long unwrapped = unwrap(deviceTime);
+	updateDeviceTime(unwrapped);
+
+	TimePoint middle = sent + (received - sent) / 2;
+	samples.push_back(Sample { unwrapped / 1000.0, std::chrono::duration<double>(middle - origin).count() });
+	if(samples.size() > historySize) samples.pop_front();
+
+	accuracy = std::min(accuracy, (received - sent) / 2);
+	fit();
+}
+
+bool HokuyoClock::addScan(TimePoint received, long deviceTime, TimePoint& captureTime)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(samples.empty()) return false;
+
+	long long unwrapped = unwrap(deviceTime);
+	updateDeviceTime(unwrapped);
+
+	double receivedTime = std::chrono::duration<double>(received - origin).count();
+	scans.push_back(Sample { unwrapped / 1000.0, receivedTime });
+	if(scans.size() > historySize) scans.pop_front();
+
+	updateCorrection();
+	double capture = std::min(predict(unwrapped), receivedTime);
+
+	captureTime = origin + std::chrono::duration_cast<TimePoint::duration>(std::chrono::duration<double>(capture));
+	return true;
+}
+
+bool HokuyoClock::toHostTime(long deviceTime, TimePoint& hostTime) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(samples.empty()) return false;
+
+	double host = predict(unwrap(deviceTime));
+	hostTime = origin + std::chrono::duration_cast<TimePoint::duration>(std::chrono::duration<double>(host));
+
+	return true;
+}
+
+bool HokuyoClock::isSynchronized() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return !samples.empty();
+}
+
+double HokuyoClock::getDrift() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return drift;
+}
+
+std::chrono::steady_clock::duration HokuyoClock::getAccuracy() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return accuracy;
+}
+
+}
@@ -23,6 +23,8 @@
 
 namespace regilo {
 
+template class HokuyoControllerBase<SerialController, HokuyoScanParser>;
+template class HokuyoControllerBase<SocketController, HokuyoScanParser>;
 template class HokuyoController<SerialController>;
 template class HokuyoController<SocketController>;
 
@@ -0,0 +1,183 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "regilo/hokuyogeometry.hpp"
+
+#include <cstdlib>
+#include <fstream>
+
+#include <boost/algorithm/string/trim.hpp>
+
+namespace regilo {
+
+namespace {
+
+void setValue(const std::map<std::string, std::string>& values, const std::string& name, std::size_t& value)
+{
+	auto it = values.find(name);
+	if(it == values.end()) return;
+
+	const char *begin = it->second.c_str();
+	char *end;
+
+	long parsed = std::strtol(begin, &end, 10);
+	if(end != begin && parsed >= 0) value = std::size_t(parsed);
+}
+
+// Parse a range like "44-725[step]" that ends with the unit
+bool parseRange(const std::string& text, const std::string& unit, std::size_t& from, std::size_t& to)
+{
+	std::size_t unitPos = text.find(unit);
+	if(unitPos == std::string::npos) return false;
+
+	std::size_t beginPos = text.find_last_of("(,", unitPos);
+	beginPos = (beginPos == std::string::npos ? 0 : beginPos + 1);
+
+	const char *begin = text.c_str() + beginPos;
+	char *end;
+
+	long parsedFrom = std::strtol(begin, &end, 10);
+	if(end == begin || *end != '-') return false;
+
+	begin = end + 1;
+	long parsedTo = std::strtol(begin, &end, 10);
+	if(end == begin || std::size_t(end - text.c_str()) != unitPos) return false;
+
+	from = std::size_t(parsedFrom);
+	to = std::size_t(parsedTo);
+
+	return true;
+}
+
+}
+
+bool HokuyoGeometry::isValid() const
+{
+	return stepsPerRevolution > 0 && validFromStep <= validToStep && frontStep <= getMaxStep() && minDistance < maxDistance;
+}
+
+std::size_t HokuyoGeometry::getStep(double angle) const
+{
+	double step = std::round(frontStep + angle / getResolution());
+	if(step <= 0) return 0;
+
+	return std::min(std::size_t(step), getMaxStep());
+}
+
+void HokuyoGeometry::setParameters(const std::map<std::string, std::string>& parameters)
+{
+	setValue(parameters, "AMIN", validFromStep);
+	setValue(parameters, "AMAX", validToStep);
+	setValue(parameters, "ARES", stepsPerRevolution);
+	setValue(parameters, "AFRT", frontStep);
+	setValue(parameters, "DMIN", minDistance);
+	setValue(parameters, "DMAX", maxDistance);
+	setValue(parameters, "SCAN", scanSpeed);
+}
+
+std::map<std::string, std::string> HokuyoGeometry::getParameters() const
+{
+	return {
+		{ "AMIN", std::to_string(validFromStep) },
+		{ "AMAX", std::to_string(validToStep) },
+		{ "ARES", std::to_string(stepsPerRevolution) },
+		{ "AFRT", std::to_string(frontStep) },
+		{ "DMIN", std::to_string(minDistance) },
+		{ "DMAX", std::to_string(maxDistance) },
+		{ "SCAN", std::to_string(scanSpeed) }
+	};
+}
+
+void HokuyoGeometry::setVersionInfo(const std::map<std::string, std::string>& versionInfo)
+{
+	auto it = versionInfo.find("FIRM");
+	if(it == versionInfo.end()) return;
+
+	const std::string& firmware = it->second;
+	parseRange(firmware, "[mm]", minDistance, maxDistance);
+	parseRange(firmware, "[step]", validFromStep, validToStep);
+
+	std::size_t rpmPos = firmware.find("[rpm]");
+	if(rpmPos != std::string::npos)
+	{
+		std::size_t beginPos = firmware.find_last_of("(,", rpmPos);
+		scanSpeed = std::strtoul(firmware.c_str() + (beginPos == std::string::npos ? 0 : beginPos + 1), nullptr, 10);
+	}
+}
+
+bool HokuyoGeometry::load(const std::string& path)
+{
+	std::ifstream file(path);
+	if(!file) return false;
+
+	std::map<std::string, std::string> parameters;
+
+	std::string line;
+	while(std::getline(file, line))
+	{
+		std::size_t colonPos = line.find(':');
+		if(colonPos == std::string::npos) continue;
+
+		std::string name = line.substr(0, colonPos);
+		std::string value = line.substr(colonPos + 1);
+
+		boost::algorithm::trim(name);
+		boost::algorithm::trim(value);
+
+		parameters[name] = value;
+	}
+
+	HokuyoGeometry geometry;
+	for(const auto& parameter : geometry.getParameters())
+	{
+		if(parameters.count(parameter.first) == 0) return false;
+	}
+
+	geometry.setParameters(parameters);
+	if(!geometry.isValid()) return false;
+
+	*this = geometry;
+	return true;
+}
+
+bool HokuyoGeometry::save(const std::string& path) const
+{
+	std::ofstream file(path);
+	for(const auto& parameter : getParameters())
+	{
+		file << parameter.first << ':' << parameter.second << std::endl;
+	}
+
+	return bool(file);
+}
+
+std::string HokuyoGeometry::getCachePath(const std::string& directory, const std::string& serialNumber)
+{
+	std::string fileName = "hokuyo-" + serialNumber + ".txt";
+	for(char& c : fileName)
+	{
+		if(c == '/' || c == '\\' || c == ' ') c = '_';
+	}
+
+	if(directory.empty() || directory.back() == '/') return directory + fileName;
+	return directory + '/' + fileName;
+}
+
+}
@@ -0,0 +1,111 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/hokuyoscanparser.hpp"
+
+namespace regilo {
+
+void HokuyoScanParser::setParameters(std::size_t fromStep, std::size_t stepIncrement, std::size_t validFromStep, std::size_t validToStep,
+									 std::size_t minDistance, double resolution, double startAngle, std::shared_ptr<const AngleTable> angleTable)
+{
+	this->fromStep = fromStep;
+	this->stepIncrement = stepIncrement;
+	this->validFromStep = validFromStep;
+	this->validToStep = validToStep;
+	this->minDistance = minDistance;
+	this->resolution = resolution;
+	this->startAngle = startAngle;
+	this->angleTable = angleTable;
+}
+
+void HokuyoScanParser::reset()
+{
+	state = State::Status;
+	hasHigh = false;
+	step = fromStep;
+	lastId = 0;
+	tableAngles = true;
+
+	if(angleTable) data->reserve(angleTable->size());
+}
+
+bool HokuyoScanParser::finish()
+{
+	if(state != State::Data) return false;
+
+	if(tableAngles) data->angleTable = angleTable;
+
+	return true;
+}
+
+void HokuyoScanParser::parse(const char *begin, const char *end)
+{
+	for(; begin != end && state != State::Failed; begin++)
+	{
+		char c = *begin;
+		if(c == '\n' || c == '\r' || c == ' ' || c == '\t') continue;
+
+		if(state == State::Status) state = (c == '0' ? State::Data : State::Failed);
+		else if(hasHigh)
+		{
+			parseValue(high, c);
+			hasHigh = false;
+		}
+		else
+		{
+			high = c;
+			hasHigh = true;
+		}
+	}
+}
+
+void HokuyoScanParser::parseValue(char high, char low)
+{
+	std::size_t currentStep = step;
+	step += stepIncrement;
+
+	if(currentStep < validFromStep || currentStep > validToStep) return;
+
+	int id = lastId++;
+	double angle;
+
+	if(angleTable && std::size_t(id) < angleTable->size()) angle = angleTable->angles[id];
+	else
+	{
+		angle = currentStep * resolution + startAngle;
+		tableAngles = false;
+	}
+
+	int distance = ((high - '0') << 6) | (low - '0');
+	int errorCode = 0;
+	bool error = false;
+
+	if(distance < int(minDistance))
+	{
+		errorCode = distance;
+		distance = -1;
+		error = true;
+	}
+
+	addRecord(id, angle, distance, -1, errorCode, error);
+}
+
+}
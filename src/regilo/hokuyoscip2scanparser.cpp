@@ -0,0 +1,235 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "regilo/hokuyoscip2scanparser.hpp"
+
+#include <stdexcept>
+
+namespace regilo {
+
+const int HokuyoScip2ScanParser::CHECKSUM_ERROR_CODE;
+const std::size_t HokuyoScip2ScanParser::MAX_LINE_VALUES;
+
+char HokuyoScip2ScanParser::checksum(const char *begin, const char *end)
+{
+	unsigned int sum = 0;
+	for(; begin != end; begin++) sum += static_cast<unsigned char>(*begin);
+
+	return char((sum & 0x3f) + 0x30);
+}
+
+long HokuyoScip2ScanParser::decode(const char *begin, const char *end)
+{
+	long value = 0;
+	for(; begin != end; begin++) value = (value << 6) | ((*begin - 0x30) & 0x3f);
+
+	return value;
+}
+
+void HokuyoScip2ScanParser::setEncoding(std::size_t encoding)
+{
+	if(encoding != 2 && encoding != 3) throw std::invalid_argument("The encoding has to be 2 or 3 characters.");
+	this->encoding = encoding;
+}
+
+void HokuyoScip2ScanParser::setParameters(std::size_t fromStep, std::size_t stepIncrement, std::size_t validFromStep, std::size_t validToStep,
+										  std::size_t minDistance, double resolution, double startAngle, std::shared_ptr<const AngleTable> angleTable)
+{
+	this->fromStep = fromStep;
+	this->stepIncrement = stepIncrement;
+	this->validFromStep = validFromStep;
+	this->validToStep = validToStep;
+	this->minDistance = minDistance;
+	this->resolution = resolution;
+	this->startAngle = startAngle;
+	this->angleTable = angleTable;
+}
+
+void HokuyoScip2ScanParser::reset()
+{
+	state = State::Status;
+	hasHeld = false;
+	sum = 0;
+	statusLength = 0;
+
+	value = 0;
+	valueLength = 0;
+	valueCorrupt = false;
+	lineValueCount = 0;
+
+	step = fromStep;
+	lastId = 0;
+	tableAngles = true;
+	timestamp = -1;
+	corruptLines = 0;
+
+	if(angleTable) data->reserve(angleTable->size());
+}
+
+bool HokuyoScip2ScanParser::finish()
+{
+	// The last line ends with the response end
+	if(hasHeld && state != State::Failed)
+	{
+		hasHeld = false;
+		endLine(held);
+	}
+
+	if(state != State::Data) return false;
+
+	if(tableAngles) data->angleTable = angleTable;
+
+	return true;
+}
+
+void HokuyoScip2ScanParser::parse(const char *begin, const char *end)
+{
+	for(; begin != end && state != State::Failed; begin++)
+	{
+		char c = *begin;
+		if(c == '\r') continue;
+
+		if(c == '\n')
+		{
+			// The last character of a line is its checksum
+			if(hasHeld)
+			{
+				hasHeld = false;
+				endLine(held);
+			}
+		}
+		else
+		{
+			if(hasHeld) parseCharacter(held);
+
+			held = c;
+			hasHeld = true;
+		}
+	}
+}
+
+void HokuyoScip2ScanParser::parseCharacter(char c)
+{
+	sum += static_cast<unsigned char>(c);
+
+	if(state == State::Status)
+	{
+		if(statusLength < 2) status[statusLength++] = c;
+		else state = State::Failed;
+	}
+	else
+	{
+		value = (value << 6) | ((c - 0x30) & 0x3f);
+		valueLength++;
+
+		if(state == State::Timestamp)
+		{
+			if(valueLength > 4) state = State::Failed;
+		}
+		else if(valueLength == encoding)
+		{
+			std::size_t currentStep = step;
+			step += stepIncrement;
+
+			if(currentStep >= validFromStep && currentStep <= validToStep && lineValueCount < MAX_LINE_VALUES)
+			{
+				lineValues[lineValueCount++] = Value { currentStep, value, valueCorrupt };
+			}
+
+			value = 0;
+			valueLength = 0;
+			valueCorrupt = false;
+		}
+	}
+}
+
+void HokuyoScip2ScanParser::endLine(char checksum)
+{
+	bool valid = (char((sum & 0x3f) + 0x30) == checksum);
+	sum = 0;
+
+	if(state == State::Status)
+	{
+		// 00 is the status of GD/GS, 99 is the status of MD/MS data
+		bool success = (statusLength == 2 && ((status[0] == '0' && status[1] == '0') || (status[0] == '9' && status[1] == '9')));
+		state = (valid && success ? State::Timestamp : State::Failed);
+	}
+	else if(state == State::Timestamp)
+	{
+		if(valid && valueLength == 4) timestamp = value;
+		else corruptLines++;
+
+		value = 0;
+		valueLength = 0;
+		state = State::Data;
+	}
+	else
+	{
+		if(!valid)
+		{
+			corruptLines++;
+			if(valueLength != 0) valueCorrupt = true;
+		}
+
+		for(std::size_t i = 0; i < lineValueCount; i++)
+		{
+			Value& lineValue = lineValues[i];
+			if(!valid) lineValue.corrupt = true;
+
+			addValue(lineValue);
+		}
+
+		lineValueCount = 0;
+	}
+}
+
+void HokuyoScip2ScanParser::addValue(const Value& value)
+{
+	int id = lastId++;
+	double angle;
+
+	if(angleTable && std::size_t(id) < angleTable->size()) angle = angleTable->angles[id];
+	else
+	{
+		angle = value.step * resolution + startAngle;
+		tableAngles = false;
+	}
+
+	double distance = value.distance;
+	int errorCode = 0;
+	bool error = false;
+
+	if(value.corrupt)
+	{
+		errorCode = CHECKSUM_ERROR_CODE;
+		distance = -1;
+		error = true;
+	}
+	else if(distance < minDistance)
+	{
+		errorCode = int(distance);
+		distance = -1;
+		error = true;
+	}
+
+	addRecord(id, angle, distance, -1, errorCode, error);
+}
+
+}
@@ -0,0 +1,171 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/neatoscanparser.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace regilo {
+
+namespace {
+
+bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+}
+
+const std::size_t NeatoScanParser::MAX_LINE_LENGTH;
+
+NeatoScanParser::NeatoScanParser(const std::string& header, const std::string& footer, std::shared_ptr<const AngleTable> angleTable) :
+	header(header),
+	footer(footer),
+	angleTable(angleTable)
+{
+}
+
+void NeatoScanParser::reset()
+{
+	state = State::Header;
+	lineLength = 0;
+	lineOverflow = false;
+	lastId = 0;
+	tableAngles = true;
+
+	data->reserve(angleTable->size());
+}
+
+bool NeatoScanParser::finish()
+{
+	if(lineLength != 0 && (state == State::Header || state == State::Records)) parseLine();
+
+	return state == State::Done;
+}
+
+void NeatoScanParser::parse(const char *begin, const char *end)
+{
+	while(begin != end && (state == State::Header || state == State::Records))
+	{
+		const char *newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+		if(newline == nullptr)
+		{
+			appendLine(begin, end);
+			break;
+		}
+
+		appendLine(begin, newline);
+		parseLine();
+
+		begin = newline + 1;
+	}
+}
+
+void NeatoScanParser::appendLine(const char *begin, const char *end)
+{
+	std::size_t length = end - begin;
+	if(lineLength + length > MAX_LINE_LENGTH)
+	{
+		length = MAX_LINE_LENGTH - lineLength;
+		lineOverflow = true;
+	}
+
+	std::memcpy(line + lineLength, begin, length);
+	lineLength += length;
+}
+
+void NeatoScanParser::parseLine()
+{
+	const char *begin = line;
+	const char *end = line + lineLength;
+
+	while(begin != end && isBlank(*begin)) begin++;
+	while(begin != end && isBlank(*(end - 1))) end--;
+
+	std::size_t length = end - begin;
+	bool overflow = lineOverflow;
+
+	lineLength = 0;
+	lineOverflow = false;
+
+	if(length == 0) return;
+	if(overflow)
+	{
+		state = State::Failed;
+		return;
+	}
+
+	line[end - line] = '\0';
+
+	if(state == State::Header)
+	{
+		state = (header.compare(0, std::string::npos, begin, length) == 0 ? State::Records : State::Failed);
+	}
+	else if(length >= footer.size() && footer.compare(0, std::string::npos, begin, footer.size()) == 0)
+	{
+		data->rotationSpeed = std::strtod(begin + footer.size(), nullptr);
+		if(tableAngles) data->angleTable = angleTable;
+
+		state = State::Done;
+	}
+	else if(!parseRecord(begin)) state = State::Failed;
+}
+
+bool NeatoScanParser::parseRecord(const char *begin)
+{
+	char *end;
+
+	double degrees = std::strtod(begin, &end);
+	if(end == begin || *end != ',') return false;
+	begin = end + 1;
+
+	double distance = std::strtod(begin, &end);
+	if(end == begin || *end != ',') return false;
+	begin = end + 1;
+
+	long intensity = std::strtol(begin, &end, 10);
+	if(end == begin || *end != ',') return false;
+	begin = end + 1;
+
+	long errorCode = std::strtol(begin, &end, 10);
+	if(end == begin) return false;
+
+	int id = lastId++;
+	double angle;
+
+	if(degrees == id && std::size_t(id) < angleTable->size()) angle = angleTable->angles[id];
+	else
+	{
+		angle = degrees * M_PI / 180.0;
+		tableAngles = false;
+	}
+
+	bool error = (errorCode != 0);
+	if(error) distance = -1;
+
+	addRecord(id, angle, distance, int(intensity), int(errorCode), error);
+
+	return true;
+}
+
+}
@@ -0,0 +1,215 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "regilo/neatotelemetry.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace regilo {
+
+namespace {
+
+bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+template<typename T>
+bool assign(const char *label, std::size_t length, const char *name, T& member, double value)
+{
+	if(std::strlen(name) != length || std::memcmp(label, name, length) != 0) return false;
+
+	member = T(value);
+	return true;
+}
+
+}
+
+bool NeatoMotors::setValue(const char *label, std::size_t length, double value)
+{
+	return assign(label, length, "Brush_RPM", brushRpm, value)
+			|| assign(label, length, "Brush_mA", brushCurrent, value)
+			|| assign(label, length, "Vacuum_RPM", vacuumRpm, value)
+			|| assign(label, length, "Vacuum_mA", vacuumCurrent, value)
+			|| assign(label, length, "LeftWheel_RPM", leftWheelRpm, value)
+			|| assign(label, length, "LeftWheel_Load%", leftWheelLoad, value)
+			|| assign(label, length, "LeftWheel_PositionInMM", leftWheelPosition, value)
+			|| assign(label, length, "LeftWheel_Speed", leftWheelSpeed, value)
+			|| assign(label, length, "RightWheel_RPM", rightWheelRpm, value)
+			|| assign(label, length, "RightWheel_Load%", rightWheelLoad, value)
+			|| assign(label, length, "RightWheel_PositionInMM", rightWheelPosition, value)
+			|| assign(label, length, "RightWheel_Speed", rightWheelSpeed, value)
+			|| assign(label, length, "SideBrush_mA", sideBrushCurrent, value);
+}
+
+bool NeatoAnalogSensors::setValue(const char *label, std::size_t length, double value)
+{
+	return assign(label, length, "WallSensorInMM", wallDistance, value)
+			|| assign(label, length, "BatteryVoltageInmV", batteryVoltage, value)
+			|| assign(label, length, "LeftDropInMM", leftDropDistance, value)
+			|| assign(label, length, "RightDropInMM", rightDropDistance, value)
+			|| assign(label, length, "LeftMagSensor", leftMagSensor, value)
+			|| assign(label, length, "RightMagSensor", rightMagSensor, value)
+			|| assign(label, length, "UIButtonInmV", uiButtonVoltage, value)
+			|| assign(label, length, "VacuumCurrentInmA", vacuumCurrent, value)
+			|| assign(label, length, "ChargeVoltInmV", chargeVoltage, value)
+			|| assign(label, length, "BatteryTemp0InC", batteryTemperature0, value)
+			|| assign(label, length, "BatteryTemp1InC", batteryTemperature1, value)
+			|| assign(label, length, "CurrentInmA", current, value)
+			|| assign(label, length, "SideBrushCurrentInmA", sideBrushCurrent, value)
+			|| assign(label, length, "VoltageReferenceInmV", voltageReference, value)
+			|| assign(label, length, "AccelXInmG", accelerationX, value)
+			|| assign(label, length, "AccelYInmG", accelerationY, value)
+			|| assign(label, length, "AccelZInmG", accelerationZ, value);
+}
+
+bool NeatoDigitalSensors::setValue(const char *label, std::size_t length, double value)
+{
+	return assign(label, length, "SNSR_DC_JACK_CONNECT", dcJackConnected, value)
+			|| assign(label, length, "SNSR_DUSTBIN_IS_IN", dustbinIn, value)
+			|| assign(label, length, "SNSR_LEFT_WHEEL_EXTENDED", leftWheelExtended, value)
+			|| assign(label, length, "SNSR_RIGHT_WHEEL_EXTENDED", rightWheelExtended, value)
+			|| assign(label, length, "LSIDEBIT", leftSideBumper, value)
+			|| assign(label, length, "LFRONTBIT", leftFrontBumper, value)
+			|| assign(label, length, "RSIDEBIT", rightSideBumper, value)
+			|| assign(label, length, "RFRONTBIT", rightFrontBumper, value);
+}
+
+bool NeatoCharger::setValue(const char *label, std::size_t length, double value)
+{
+	return assign(label, length, "FuelPercent", fuelPercent, value)
+			|| assign(label, length, "BatteryOverTemp", batteryOverTemperature, value)
+			|| assign(label, length, "ChargingActive", chargingActive, value)
+			|| assign(label, length, "ChargingEnabled", chargingEnabled, value)
+			|| assign(label, length, "ConfidentOnFuel", confidentOnFuel, value)
+			|| assign(label, length, "OnReservedFuel", onReservedFuel, value)
+			|| assign(label, length, "EmptyFuel", emptyFuel, value)
+			|| assign(label, length, "BatteryFailure", batteryFailure, value)
+			|| assign(label, length, "ExtPwrPresent", externalPowerPresent, value)
+			|| assign(label, length, "VBattV", batteryVoltage, value)
+			|| assign(label, length, "VExtV", externalVoltage, value)
+			|| assign(label, length, "Charger_mAH", chargerCapacity, value);
+}
+
+NeatoSensorData& NeatoTelemetry::operator[](NeatoSensor sensor)
+{
+	return const_cast<NeatoSensorData&>(static_cast<const NeatoTelemetry&>(*this)[sensor]);
+}
+
+const NeatoSensorData& NeatoTelemetry::operator[](NeatoSensor sensor) const
+{
+	switch(sensor)
+	{
+		case NeatoSensor::Motors: return motors;
+		case NeatoSensor::AnalogSensors: return analogSensors;
+		case NeatoSensor::DigitalSensors: return digitalSensors;
+		default: return charger;
+	}
+}
+
+const std::size_t NeatoTelemetryParser::MAX_LINE_LENGTH;
+
+void NeatoTelemetryParser::begin(NeatoSensorData& data)
+{
+	this->data = &data;
+
+	header = true;
+	lineLength = 0;
+	lineOverflow = false;
+	values = 0;
+}
+
+void NeatoTelemetryParser::parse(const char *begin, const char *end)
+{
+	while(begin != end)
+	{
+		const char *newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+		if(newline == nullptr)
+		{
+			appendLine(begin, end);
+			break;
+		}
+
+		appendLine(begin, newline);
+		parseLine();
+
+		begin = newline + 1;
+	}
+}
+
+bool NeatoTelemetryParser::end()
+{
+	if(lineLength != 0) parseLine();
+	data = nullptr;
+
+	return values != 0;
+}
+
+void NeatoTelemetryParser::appendLine(const char *begin, const char *end)
+{
+	std::size_t length = end - begin;
+	if(lineLength + length > MAX_LINE_LENGTH)
+	{
+		length = MAX_LINE_LENGTH - lineLength;
+		lineOverflow = true;
+	}
+
+	std::memcpy(line + lineLength, begin, length);
+	lineLength += length;
+}
+
+void NeatoTelemetryParser::parseLine()
+{
+	const char *begin = line;
+	const char *end = line + lineLength;
+
+	while(begin != end && isBlank(*begin)) begin++;
+	while(begin != end && isBlank(*(end - 1))) end--;
+
+	bool overflow = lineOverflow;
+
+	lineLength = 0;
+	lineOverflow = false;
+
+	if(begin == end || overflow) return;
+
+	// The first line contains the column names
+	if(header)
+	{
+		header = false;
+		return;
+	}
+
+	line[end - line] = '\0';
+
+	const char *labelEnd = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+	if(labelEnd == nullptr) return;
+
+	const char *valueBegin = std::strrchr(labelEnd, ',') + 1;
+
+	char *valueEnd;
+	double value = std::strtod(valueBegin, &valueEnd);
+	if(valueEnd == valueBegin) return;
+
+	if(data->setValue(begin, labelEnd - begin, value)) values++;
+}
+
+}
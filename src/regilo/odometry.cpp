@@ -0,0 +1,115 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "regilo/odometry.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace regilo {
+
+Odometry::Odometry(double wheelBase, std::size_t historySize) :
+	wheelBase(wheelBase),
+	samples(historySize)
+{
+	if(historySize == 0) throw std::invalid_argument("The history size has to be positive.");
+}
+
+const Odometry::Sample& Odometry::getSample(std::size_t index) const
+{
+	return samples[(first + index) % samples.size()];
+}
+
+void Odometry::update(TimePoint time, double left, double right)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(initialized)
+	{
+		double leftDistance = left - lastLeft;
+		double rightDistance = right - lastRight;
+
+		double distance = (leftDistance + rightDistance) / 2;
+		double rotation = (rightDistance - leftDistance) / wheelBase;
+
+		// The midpoint heading is used for the whole arc
+		pose.x += distance * std::cos(pose.theta + rotation / 2);
+		pose.y += distance * std::sin(pose.theta + rotation / 2);
+		pose.theta += rotation;
+	}
+	else initialized = true;
+
+	lastLeft = left;
+	lastRight = right;
+
+	if(count == samples.size())
+	{
+		first = (first + 1) % samples.size();
+		count--;
+	}
+
+	samples[(first + count) % samples.size()] = Sample { time, pose };
+	count++;
+}
+
+void Odometry::reset(const Pose& pose)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	this->pose = pose;
+	initialized = false;
+	first = 0;
+	count = 0;
+}
+
+Pose Odometry::getPose() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pose;
+}
+
+bool Odometry::getPose(TimePoint time, Pose& pose) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(count == 0 || time < getSample(0).time || time > getSample(count - 1).time) return false;
+
+	// The newest samples are the most likely ones
+	std::size_t index = count - 1;
+	while(index > 0 && getSample(index - 1).time >= time) index--;
+
+	const Sample& next = getSample(index);
+	if(index == 0 || next.time == time)
+	{
+		pose = next.pose;
+		return true;
+	}
+
+	const Sample& previous = getSample(index - 1);
+	double ratio = std::chrono::duration<double>(time - previous.time).count() / std::chrono::duration<double>(next.time - previous.time).count();
+
+	pose.x = previous.pose.x + ratio * (next.pose.x - previous.pose.x);
+	pose.y = previous.pose.y + ratio * (next.pose.y - previous.pose.y);
+	pose.theta = previous.pose.theta + ratio * (next.pose.theta - previous.pose.theta);
+
+	return true;
+}
+
+}
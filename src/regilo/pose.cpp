@@ -0,0 +1,46 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/pose.hpp"
+
+#include <iostream>
+
+namespace regilo {
+
+Pose::Pose(double x, double y, double theta) :
+	x(x), y(y), theta(theta)
+{
+}
+
+std::ostream& operator<<(std::ostream& out, const Pose& pose)
+{
+	out << "Pose("
+		<< pose.x
+		<< "mm, "
+		<< pose.y
+		<< "mm, "
+		<< pose.theta
+		<< "rad)";
+
+	return out;
+}
+
+}
@@ -30,6 +30,26 @@ ScanData::ScanData(std::size_t scanId, double rotationSpeed) :
 {
 }
 
+void ScanData::reset()
+{
+	clear();
+
+	scanId = std::size_t(-1);
+	rotationSpeed = -1;
+	time = 0;
+	steadyTime = std::chrono::steady_clock::time_point();
+	duplicate = false;
+	angleTable.reset();
+}
+
+std::chrono::steady_clock::time_point ScanData::getRecordTime(std::size_t index) const
+{
+	if(rotationSpeed <= 0 || empty()) return steadyTime;
+
+	std::chrono::duration<double> sinceRecord((size() - 1 - index) / (rotationSpeed * size()));
+	return steadyTime - std::chrono::duration_cast<std::chrono::steady_clock::duration>(sinceRecord);
+}
+
 std::ostream& operator<<(std::ostream& out, const ScanData& data)
 {
 	out << "ScanData("
@@ -0,0 +1,182 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/scandatapool.hpp"
+
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace regilo {
+
+class ScanDataPool::Storage
+{
+public:
+	std::mutex mutex;
+	std::size_t recordCapacity;
+	std::size_t size = 0;
+
+	std::vector<ScanData*> freeData;
+
+	std::size_t blockSize = 0;
+	std::size_t blockCount = 0;
+	std::vector<void*> freeBlocks;
+
+	Storage(std::size_t recordCapacity);
+	~Storage();
+
+	ScanData* acquireData();
+	void releaseData(ScanData *data);
+
+	void* allocateBlock(std::size_t size);
+	void deallocateBlock(void *block, std::size_t size);
+};
+
+class ScanDataPool::Deleter
+{
+private:
+	std::shared_ptr<Storage> storage;
+
+public:
+	Deleter(const std::shared_ptr<Storage>& storage) : storage(storage) {}
+
+	inline void operator()(ScanData *data) const { storage->releaseData(data); }
+};
+
+template<typename T>
+class ScanDataPool::BlockAllocator
+{
+public:
+	typedef T value_type;
+
+	std::shared_ptr<Storage> storage;
+
+	BlockAllocator(const std::shared_ptr<Storage>& storage) : storage(storage) {}
+
+	template<typename U>
+	BlockAllocator(const BlockAllocator<U>& allocator) : storage(allocator.storage) {}
+
+	inline T* allocate(std::size_t n) { return static_cast<T*>(storage->allocateBlock(n * sizeof(T))); }
+	inline void deallocate(T *block, std::size_t n) { storage->deallocateBlock(block, n * sizeof(T)); }
+
+	template<typename U>
+	inline bool operator==(const BlockAllocator<U>& allocator) const { return storage == allocator.storage; }
+
+	template<typename U>
+	inline bool operator!=(const BlockAllocator<U>& allocator) const { return storage != allocator.storage; }
+};
+
+ScanDataPool::Storage::Storage(std::size_t recordCapacity) :
+	recordCapacity(recordCapacity)
+{
+}
+
+ScanDataPool::Storage::~Storage()
+{
+	for(ScanData *data : freeData) delete data;
+	for(void *block : freeBlocks) ::operator delete(block);
+}
+
+ScanData* ScanDataPool::Storage::acquireData()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(freeData.empty())
+	{
+		// Make sure that releasing the data never allocates
+		freeData.reserve(size + 1);
+
+		ScanData *data = new ScanData();
+		data->reserve(recordCapacity);
+		size++;
+
+		return data;
+	}
+
+	ScanData *data = freeData.back();
+	freeData.pop_back();
+
+	return data;
+}
+
+void ScanDataPool::Storage::releaseData(ScanData *data)
+{
+	data->reset();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	freeData.push_back(data);
+}
+
+void* ScanDataPool::Storage::allocateBlock(std::size_t size)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(blockSize == 0) blockSize = size;
+	if(size != blockSize) return ::operator new(size);
+
+	if(freeBlocks.empty())
+	{
+		freeBlocks.reserve(blockCount + 1);
+		blockCount++;
+
+		return ::operator new(size);
+	}
+
+	void *block = freeBlocks.back();
+	freeBlocks.pop_back();
+
+	return block;
+}
+
+void ScanDataPool::Storage::deallocateBlock(void *block, std::size_t size)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(size == blockSize) freeBlocks.push_back(block);
+	else ::operator delete(block);
+}
+
+ScanDataPool::ScanDataPool(std::size_t size, std::size_t recordCapacity) :
+	storage(std::make_shared<Storage>(recordCapacity))
+{
+	std::vector<ScanData*> data;
+	for(std::size_t i = 0; i < size; i++) data.push_back(storage->acquireData());
+	for(ScanData *scanData : data) storage->releaseData(scanData);
+}
+
+std::shared_ptr<ScanData> ScanDataPool::acquire()
+{
+	return std::shared_ptr<ScanData>(storage->acquireData(), Deleter(storage), BlockAllocator<ScanData>(storage));
+}
+
+std::size_t ScanDataPool::getSize() const
+{
+	std::lock_guard<std::mutex> lock(storage->mutex);
+	return storage->size;
+}
+
+std::size_t ScanDataPool::getFreeCount() const
+{
+	std::lock_guard<std::mutex> lock(storage->mutex);
+	return storage->freeData.size();
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/scanparser.hpp"
+
+namespace regilo {
+
+void ScanParser::flushSector()
+{
+	if(sectorSize != 0 && data->size() > sectorFrom)
+	{
+		sectorCallback(*data, sectorFrom, data->size());
+		sectorFrom = data->size();
+	}
+}
+
+void ScanParser::begin(ScanData& data)
+{
+	this->data = &data;
+	sectorFrom = data.size();
+
+	reset();
+}
+
+bool ScanParser::end()
+{
+	bool status = finish();
+	flushSector();
+
+	data = nullptr;
+
+	return status;
+}
+
+void ScanParser::setSectorCallback(std::size_t sectorSize, const SectorCallback& callback)
+{
+	this->sectorSize = (callback ? sectorSize : 0);
+	sectorCallback = callback;
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "regilo/scanpollscheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace regilo {
+
+ScanPollScheduler::ScanPollScheduler(IScanController& controller, double rotationSpeed, std::chrono::milliseconds precision) :
+	controller(controller), rotationSpeed(rotationSpeed), precision(precision)
+{
+	step = getPeriod() / 4;
+}
+
+bool ScanPollScheduler::isNewRotation(const ScanData& data)
+{
+	if(data.duplicate) return false;
+
+	bool same = (data.size() == lastDistances.size());
+	for(std::size_t i = 0; same && i < data.size(); i++)
+	{
+		same = (data[i].distance == lastDistances[i] && data[i].intensity == lastIntensities[i]);
+	}
+
+	if(same) return false;
+
+	lastDistances.resize(data.size());
+	lastIntensities.resize(data.size());
+	for(std::size_t i = 0; i < data.size(); i++)
+	{
+		lastDistances[i] = data[i].distance;
+		lastIntensities[i] = data[i].intensity;
+	}
+
+	return true;
+}
+
+void ScanPollScheduler::getScan(ScanData& data)
+{
+	while(true)
+	{
+		std::this_thread::sleep_until(nextPoll);
+
+		std::chrono::steady_clock::time_point pollTime = std::chrono::steady_clock::now();
+		controller.getScan(data);
+
+		bool newRotation = isNewRotation(data);
+		update(pollTime, newRotation, data.rotationSpeed);
+
+		if(newRotation || data.empty()) break;
+	}
+}
+
+std::chrono::steady_clock::time_point ScanPollScheduler::update(std::chrono::steady_clock::time_point pollTime, bool newRotation, double rotationSpeed)
+{
+	polls++;
+	if(rotationSpeed > 0) this->rotationSpeed = rotationSpeed;
+
+	std::chrono::steady_clock::duration period = getPeriod();
+
+	if(!newRotation)
+	{
+		// Too early, the rotation ends within the next step
+		stalePolls++;
+		lastPollStale = true;
+
+		nextPoll = pollTime + std::max(step, precision);
+	}
+	else if(lastPollStale)
+	{
+		// The end of the rotation is between the stale poll and this one
+		lastPollStale = false;
+		step = std::max(precision, step / 2);
+
+		nextPoll = pollTime + period;
+	}
+	else if(step > precision)
+	{
+		// The end of the rotation is not found yet, so the next poll goes earlier
+		nextPoll = pollTime + period - step;
+	}
+	else
+	{
+		// Locked, a small lead detects the drift of the rotation
+		nextPoll = pollTime + period - precision / 4;
+	}
+
+	return nextPoll;
+}
+
+std::chrono::steady_clock::duration ScanPollScheduler::getPeriod() const
+{
+	return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1 / rotationSpeed));
+}
+
+}
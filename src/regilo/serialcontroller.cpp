@@ -29,4 +29,12 @@ void SerialController::connect(const std::string& endpoint)
 	stream.open(endpoint);
 }
 
+void SerialController::reopen()
+{
+	boost::system::error_code ec;
+	stream.close(ec);
+
+	stream.open(endpoint);
+}
+
 }
@@ -54,9 +54,18 @@ void SocketController::connect(const std::string& ip, unsigned short port)
 
 void SocketController::connect(const bai::tcp::endpoint& endpoint)
 {
+	remoteEndpoint = endpoint;
 	stream.connect(endpoint);
 }
 
+void SocketController::reopen()
+{
+	boost::system::error_code ec;
+	stream.close(ec);
+
+	stream.connect(remoteEndpoint);
+}
+
 std::string SocketController::getEndpoint() const
 {
 	if(!isConnected()) return "";
@@ -21,6 +21,8 @@
 
 #include "regilo/utils.hpp"
 
+#include "regilo/delimitermatcher.hpp"
+
 namespace regilo {
 
 std::istream& getLine(std::istream& stream, std::string& line, const std::string& delim)
@@ -29,38 +31,29 @@ std::istream& getLine(std::istream& stream, std::string& line, const std::string
 	else if(delim.size() == 1) return std::getline(stream, line, delim.front());
 	else
 	{
-		char c;
-		stream.get(c);
+		// Every delimiter ends with its last char, so the stream is read in bulk up to the char
+		DelimiterMatcher matcher(delim);
+		std::string part, result;
 
-		std::string delimPart, result;
-		while(stream)
+		while(std::getline(stream, part, delim.back()))
 		{
-			if(c == delim.at(delimPart.size()))
-			{
-				delimPart += c;
-				if(delimPart.size() == delim.size())
-				{
-					delimPart.clear();
-					break;
-				}
-			}
-			else
-			{
-				if(!delimPart.empty())
-				{
-					result += delimPart;
-					delimPart.clear();
-				}
+			bool complete = !stream.eof();
+			if(complete) part += delim.back();
+
+			bool found = (matcher.find(part.data(), part.data() + part.size()) != nullptr);
+			result += part;
 
-				result += c;
+			if(found)
+			{
+				result.resize(result.size() - delim.size());
+				break;
 			}
 
-			if(stream.peek() == EOF) break;
-			else stream.get(c);
+			if(!complete) break;
 		}
 
-		if(!delimPart.empty()) result += delimPart;
 		if(!result.empty()) line = result;
+		if(!result.empty()) stream.clear(stream.rdstate() & ~std::ios::failbit);
 
 		return stream;
 	}
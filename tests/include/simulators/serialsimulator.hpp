@@ -35,6 +35,7 @@ class SerialSimulator : public Simulator
 private:
 	int ptmx;
 	bool opened = false;
+	std::string pending;
 
 protected:
 	inline virtual std::string read() override { return read(256); }
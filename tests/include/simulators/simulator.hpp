@@ -50,6 +50,8 @@ public:
 	virtual std::string getEndpoint() const = 0;
 
 	virtual bool run();
+
+	static std::string createRepeatedLog(const std::string& logPath, const std::string& command, std::size_t count);
 };
 
 #endif // SIMULATOR_HPP
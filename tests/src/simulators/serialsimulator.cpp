@@ -21,6 +21,8 @@
 
 #include "simulators/serialsimulator.hpp"
 
+#include <vector>
+
 #include <unistd.h>
 
 SerialSimulator::~SerialSimulator()
@@ -48,36 +50,32 @@ void SerialSimulator::stop()
 
 std::string SerialSimulator::read(std::size_t bufferSize)
 {
-	std::string response;
-	char *buffer = new char[bufferSize];
+	std::vector<char> buffer(bufferSize);
 
-	ssize_t readBytes;
-	std::size_t found = 0;
-	while((readBytes = ::read(ptmx, buffer, bufferSize - 1)) > 0)
+	while(true)
 	{
 		if(!requestEnd.empty())
 		{
-			for(int i = 0; i < readBytes; i++)
+			std::size_t found = pending.find(requestEnd);
+			if(found != std::string::npos)
 			{
-				if(buffer[i] == requestEnd[found])
-				{
-					found++;
-					if(found == requestEnd.length())
-					{
-						response.append(buffer, i + 1);
-						delete[] buffer;
+				std::string request = pending.substr(0, found + requestEnd.length());
+				pending.erase(0, found + requestEnd.length());
 
-						return response;
-					}
-				}
-				else found = 0;
+				return request;
 			}
 		}
 
-		response.append(buffer, readBytes);
+		ssize_t readBytes = ::read(ptmx, buffer.data(), buffer.size());
+		if(readBytes <= 0) break;
+
+		pending.append(buffer.data(), readBytes);
 	}
 
-	return response;
+	std::string request;
+	request.swap(pending);
+
+	return request;
 }
 
 bool SerialSimulator::write(const std::string& data)
@@ -21,6 +21,8 @@
 
 #include "simulators/simulator.hpp"
 
+#include <sstream>
+
 Simulator::Simulator(const std::string& filePath) :
 	log(filePath)
 {
@@ -49,3 +51,21 @@ bool Simulator::run()
 
 	return true;
 }
+
+std::string Simulator::createRepeatedLog(const std::string& logPath, const std::string& command, std::size_t count)
+{
+	regilo::Log log(logPath);
+
+	std::string logCommand;
+	std::string logResponse = log.readCommand(command, logCommand);
+
+	std::ostringstream repeatedLog;
+	repeatedLog << '1' << log.MESSAGE_END;
+
+	for(std::size_t i = 0; i < count; i++)
+	{
+		repeatedLog << logCommand << log.MESSAGE_END << logResponse << log.MESSAGE_END;
+	}
+
+	return repeatedLog.str();
+}
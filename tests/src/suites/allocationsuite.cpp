@@ -0,0 +1,137 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+#include <boost/mpl/vector.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/hokuyocontroller.hpp"
+#include "regilo/neatocontroller.hpp"
+
+#include "simulators/serialsimulator.hpp"
+#include "simulators/socketsimulator.hpp"
+
+#include "allocationcounter.hpp"
+
+#define AF AllocationFixture<ScanController>
+
+template<typename ScanController>
+struct AllocationFixture
+{
+	static const bool isNeato = std::is_base_of<regilo::INeatoController, ScanController>::value;
+	static const bool isSerial = std::is_base_of<regilo::SerialController, ScanController>::value;
+
+	std::string logPath = (isNeato ? "data/neato-log-scan-move-time.txt" : "data/hokuyo-log-scan-version.txt");
+	std::string scanCommand = (isNeato ? "getldsscan" : "G00076801");
+	std::string responseEnd = (isNeato ? std::string(1, 0x1a) : std::string("\n\n"));
+
+	std::size_t warmUpCount = 2;
+	std::size_t scanCount = 10;
+
+	// The maximum number of allocations per one steady-state getScan() call.
+	std::size_t scanBudget = 0;
+
+	std::size_t measureScanAllocations()
+	{
+		std::stringstream logStream(Simulator::createRepeatedLog(logPath, scanCommand, warmUpCount + scanCount));
+
+		Simulator *simulator = nullptr;
+		if(isSerial) simulator = new SerialSimulator(logStream);
+		else simulator = new SocketSimulator(logStream, 12345);
+
+		simulator->responseEnd = responseEnd;
+		simulator->start();
+
+		bool deviceStatus = false;
+		std::thread deviceThread([simulator, &deviceStatus] ()
+		{
+			deviceStatus = simulator->run();
+		});
+
+		std::size_t allocationCount = 0;
+
+		{
+			ScanController controller;
+			controller.connect(simulator->getEndpoint());
+			BOOST_REQUIRE(controller.isConnected());
+
+			regilo::ScanData data;
+			for(std::size_t i = 0; i < warmUpCount; i++)
+			{
+				controller.getScan(data);
+				BOOST_REQUIRE(!data.empty());
+			}
+
+			AllocationCounter counter;
+			for(std::size_t i = 0; i < scanCount; i++)
+			{
+				controller.getScan(data);
+			}
+			allocationCount = counter.count();
+		}
+
+		if(deviceThread.joinable()) deviceThread.join();
+		delete simulator;
+
+		BOOST_CHECK(deviceStatus);
+
+		return allocationCount;
+	}
+};
+
+typedef boost::mpl::vector<regilo::NeatoSerialController, regilo::NeatoSocketController,
+						   regilo::HokuyoSerialController, regilo::HokuyoSocketController> ScanControllers;
+
+BOOST_AUTO_TEST_SUITE(AllocationSuite)
+
+BOOST_AUTO_TEST_CASE(AllocationCounterCount)
+{
+	AllocationCounter counter;
+	BOOST_CHECK_EQUAL(counter.count(), 0);
+
+	int *value = new int(5);
+	BOOST_CHECK_EQUAL(counter.count(), 1);
+	delete value;
+
+	// The allocations of other threads are not counted (only the thread creation itself may be)
+	counter.reset();
+	std::thread thread([] ()
+	{
+		for(int i = 0; i < 100; i++) std::string text(100, 'x');
+	});
+	thread.join();
+
+	BOOST_CHECK_LT(counter.count(), 100);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(AllocationScanBudget, ScanController, ScanControllers, AF)
+{
+	std::size_t allocations = AF::measureScanAllocations();
+	BOOST_TEST_MESSAGE("Allocations per scan: " << double(allocations) / AF::scanCount);
+
+	BOOST_CHECK_LE(allocations, AF::scanBudget * AF::scanCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
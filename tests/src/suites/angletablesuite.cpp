@@ -0,0 +1,100 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <iostream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/angletable.hpp"
+#include "regilo/hokuyocontroller.hpp"
+#include "regilo/neatocontroller.hpp"
+
+BOOST_AUTO_TEST_SUITE(AngleTableSuite)
+
+BOOST_AUTO_TEST_CASE(AngleTableConstructorValues)
+{
+	regilo::AngleTable emptyTable;
+	BOOST_CHECK(emptyTable.empty());
+
+	double resolution = 0.25;
+	double startAngle = -1;
+	regilo::AngleTable table(2, 5, 3, resolution, startAngle);
+
+	BOOST_REQUIRE_EQUAL(table.size(), 5);
+	BOOST_REQUIRE_EQUAL(table.cosines.size(), 5);
+	BOOST_REQUIRE_EQUAL(table.sines.size(), 5);
+
+	for(std::size_t i = 0; i < table.size(); i++)
+	{
+		double angle = (2 + i * 3) * resolution + startAngle;
+
+		BOOST_CHECK_EQUAL(table.angles.at(i), angle);
+		BOOST_CHECK_EQUAL(table.cosines.at(i), std::cos(angle));
+		BOOST_CHECK_EQUAL(table.sines.at(i), std::sin(angle));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(AngleTableNeatoScan)
+{
+	regilo::NeatoSerialController controller("data/neato-log-scan-move-time.txt");
+	regilo::ScanData data = controller.getScan(false);
+
+	BOOST_REQUIRE(data.angleTable == regilo::NeatoSerialController::LDS_ANGLE_TABLE);
+	BOOST_REQUIRE_EQUAL(data.angleTable->size(), data.size());
+
+	for(const regilo::ScanRecord& record : data)
+	{
+		BOOST_CHECK_EQUAL(data.angleTable->angles.at(record.id), record.angle);
+		BOOST_CHECK_EQUAL(data.angleTable->cosines.at(record.id), std::cos(record.angle));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(AngleTableHokuyoScan)
+{
+	regilo::HokuyoSerialController controller("data/hokuyo-log-scan-version.txt");
+	regilo::ScanData data = controller.getScan(false);
+
+	BOOST_REQUIRE(data.angleTable == controller.getAngleTable());
+	BOOST_REQUIRE_EQUAL(data.angleTable->size(), data.size());
+
+	for(const regilo::ScanRecord& record : data)
+	{
+		BOOST_CHECK_EQUAL(data.angleTable->angles.at(record.id), record.angle);
+		BOOST_CHECK_EQUAL(data.angleTable->sines.at(record.id), std::sin(record.angle));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(AngleTableHokuyoScanParameters)
+{
+	regilo::HokuyoSerialController controller;
+
+	controller.setScanParameters(0, 768, 1);
+	BOOST_CHECK_EQUAL(controller.getAngleTable()->size(), 682);
+
+	controller.setScanParameters(40, 100, 10);
+	std::shared_ptr<const regilo::AngleTable> table = controller.getAngleTable();
+	BOOST_REQUIRE_EQUAL(table->size(), 6);
+	BOOST_CHECK_CLOSE(table->angles.front(), 50 * M_PI / 512 - 135 * M_PI / 180, 0.00001);
+	BOOST_CHECK_CLOSE(table->angles.back(), 100 * M_PI / 512 - 135 * M_PI / 180, 0.00001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,235 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/cartesian.hpp"
+#include "regilo/hokuyocontroller.hpp"
+#include "regilo/neatocontroller.hpp"
+
+namespace {
+
+template<typename T>
+void checkPoints(const regilo::ScanData& data, const std::vector<regilo::Point<T>>& points, const regilo::Pose& pose, double tolerance)
+{
+	std::size_t i = 0;
+	for(const regilo::ScanRecord& record : data)
+	{
+		if(record.error) continue;
+		BOOST_REQUIRE_LT(i, points.size());
+
+		double angle = record.angle + pose.theta;
+		double x = pose.x + record.distance * std::cos(angle);
+		double y = pose.y + record.distance * std::sin(angle);
+
+		BOOST_CHECK_SMALL(points.at(i).x - x, tolerance);
+		BOOST_CHECK_SMALL(points.at(i).y - y, tolerance);
+		i++;
+	}
+
+	BOOST_CHECK_EQUAL(i, points.size());
+}
+
+template<typename T>
+void checkDeskewedPoints(const regilo::ScanData& data, const std::vector<regilo::Point<T>>& points,
+						 const regilo::Pose& startPose, const regilo::Pose& endPose, double tolerance)
+{
+	std::size_t i = 0;
+	for(std::size_t index = 0; index < data.size(); index++)
+	{
+		const regilo::ScanRecord& record = data[index];
+		if(record.error) continue;
+		BOOST_REQUIRE_LT(i, points.size());
+
+		double ratio = double(index) / (data.size() - 1);
+		regilo::Pose pose(startPose.x + ratio * (endPose.x - startPose.x), startPose.y + ratio * (endPose.y - startPose.y),
+						  startPose.theta + ratio * (endPose.theta - startPose.theta));
+
+		double angle = record.angle + pose.theta;
+		double x = pose.x + record.distance * std::cos(angle);
+		double y = pose.y + record.distance * std::sin(angle);
+
+		BOOST_CHECK_SMALL(points.at(i).x - x, tolerance);
+		BOOST_CHECK_SMALL(points.at(i).y - y, tolerance);
+		i++;
+	}
+
+	BOOST_CHECK_EQUAL(i, points.size());
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(CartesianSuite)
+
+BOOST_AUTO_TEST_CASE(CartesianNeatoScan)
+{
+	regilo::NeatoSerialController controller("data/neato-log-scan-move-time.txt");
+	regilo::ScanData data = controller.getScan(false);
+	BOOST_REQUIRE(data.angleTable);
+
+	std::vector<regilo::Point<double>> points;
+	std::size_t count = regilo::toCartesian(data, points);
+
+	BOOST_CHECK_EQUAL(count, points.size());
+	checkPoints(data, points, regilo::Pose(), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(CartesianHokuyoScanPose)
+{
+	regilo::HokuyoSerialController controller("data/hokuyo-log-scan-version.txt");
+	regilo::ScanData data = controller.getScan(false);
+	BOOST_REQUIRE(data.angleTable);
+
+	regilo::Pose pose(120, -35.5, 0.75);
+
+	std::vector<regilo::Point<double>> points;
+	regilo::toCartesian(data, points, pose);
+	checkPoints(data, points, pose, 1e-6);
+
+	std::vector<regilo::Point<float>> floatPoints;
+	regilo::toCartesian(data, floatPoints, pose);
+	checkPoints(data, floatPoints, pose, 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(CartesianWithoutAngleTable)
+{
+	regilo::NeatoSerialController controller("data/neato-log-scan-move-time.txt");
+	regilo::ScanData data = controller.getScan(false);
+	data.angleTable.reset();
+
+	regilo::Pose pose(-10, 20, -1.5);
+
+	std::vector<regilo::Point<double>> points;
+	regilo::toCartesian(data, points, pose);
+	checkPoints(data, points, pose, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(CartesianErrorRecords)
+{
+	regilo::ScanData data;
+	data.emplace_back(0, 0, 100, -1, 0, false);
+	data.emplace_back(1, M_PI / 2, -1, -1, 1, true);
+	data.emplace_back(2, M_PI, 200, -1, 0, false);
+	data.emplace_back(3, 3 * M_PI / 2, -1, -1, 1, true);
+	data.emplace_back(4, 0, 300, -1, 0, false);
+
+	std::vector<regilo::Point<double>> points(10);
+	BOOST_CHECK_EQUAL(regilo::toCartesian(data, points), 3);
+	checkPoints(data, points, regilo::Pose(), 1e-6);
+
+	data.clear();
+	BOOST_CHECK_EQUAL(regilo::toCartesian(data, points), 0);
+	BOOST_CHECK(points.empty());
+}
+
+BOOST_AUTO_TEST_CASE(CartesianTransformPaths)
+{
+	// An odd size, so the scalar code also handles the rest of the last vector
+	const std::size_t size = 37;
+	std::vector<double> distances(size), cosines(size), sines(size), poseX(size), poseY(size), poseCos(size), poseSin(size);
+	for(std::size_t i = 0; i < size; i++)
+	{
+		distances[i] = 100 + 37.5 * i;
+		cosines[i] = std::cos(0.1 * i);
+		sines[i] = std::sin(0.1 * i);
+		poseX[i] = -20 + i;
+		poseY[i] = 15 - 0.5 * i;
+		poseCos[i] = std::cos(0.3 + 0.01 * i);
+		poseSin[i] = std::sin(0.3 + 0.01 * i);
+	}
+
+	regilo::PolarArrays input { distances.data(), cosines.data(), sines.data(), poseX.data(), poseY.data(), poseCos.data(), poseSin.data() };
+
+	std::vector<double> x(size), y(size), scalarX(size), scalarY(size);
+	regilo::transformPolar(input, size, x.data(), y.data());
+	regilo::transformPolar(input, size, scalarX.data(), scalarY.data(), false);
+
+	for(std::size_t i = 0; i < size; i++)
+	{
+		double angle = 0.1 * i + 0.3 + 0.01 * i;
+		BOOST_CHECK_SMALL(scalarX[i] - (poseX[i] + distances[i] * std::cos(angle)), 1e-6);
+		BOOST_CHECK_SMALL(scalarY[i] - (poseY[i] + distances[i] * std::sin(angle)), 1e-6);
+
+		BOOST_CHECK_SMALL(x[i] - scalarX[i], 1e-9);
+		BOOST_CHECK_SMALL(y[i] - scalarY[i], 1e-9);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CartesianDeskew)
+{
+	regilo::NeatoSerialController controller("data/neato-log-scan-move-time.txt");
+	regilo::ScanData data = controller.getScan(false);
+	BOOST_REQUIRE(data.angleTable);
+
+	regilo::Pose startPose(0, 0, 0.1);
+	regilo::Pose endPose(40, -10, 0.3);
+
+	std::vector<regilo::Point<double>> points;
+	regilo::toCartesian(data, points, startPose, endPose);
+	checkDeskewedPoints(data, points, startPose, endPose, 1e-6);
+
+	std::vector<regilo::Point<float>> floatPoints;
+	regilo::toCartesian(data, floatPoints, startPose, endPose);
+	checkDeskewedPoints(data, floatPoints, startPose, endPose, 0.01);
+
+	data.angleTable.reset();
+	regilo::toCartesian(data, points, startPose, endPose);
+	checkDeskewedPoints(data, points, startPose, endPose, 1e-6);
+
+	// Without the motion it is the same as the plain conversion
+	regilo::toCartesian(data, points, endPose, endPose);
+	checkPoints(data, points, endPose, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(CartesianScanMotion)
+{
+	regilo::ScanData data;
+	for(int i = 0; i < 5; i++) data.emplace_back(i, 0, 100, -1, 0, false);
+
+	data.rotationSpeed = 5;
+	data.steadyTime = std::chrono::steady_clock::time_point(std::chrono::seconds(10));
+
+	// One revolution takes 200 ms
+	BOOST_CHECK(data.getRecordTime(4) == data.steadyTime);
+	BOOST_CHECK(data.getRecordTime(0) == data.steadyTime - std::chrono::milliseconds(160));
+
+	regilo::Pose startPose = regilo::getScanStartPose(data, regilo::Pose(100, 0, 1), regilo::Pose(500, 0, 2));
+	BOOST_CHECK_CLOSE(startPose.x, 20, 1e-6);
+	BOOST_CHECK_CLOSE(startPose.theta, 0.68, 1e-6);
+
+	regilo::Odometry odometry(200);
+	odometry.update(data.steadyTime - std::chrono::milliseconds(200), 0, 0);
+	odometry.update(data.steadyTime, 100, 100);
+
+	regilo::Pose endPose;
+	BOOST_REQUIRE(regilo::getScanMotion(data, odometry, startPose, endPose));
+	BOOST_CHECK_CLOSE(startPose.x, 20, 1e-6);
+	BOOST_CHECK_CLOSE(endPose.x, 100, 1e-6);
+
+	data.steadyTime += std::chrono::milliseconds(1);
+	BOOST_CHECK(!regilo::getScanMotion(data, odometry, startPose, endPose));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
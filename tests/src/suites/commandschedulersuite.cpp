@@ -0,0 +1,278 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/commandscheduler.hpp"
+
+typedef regilo::CommandScheduler::Priority Priority;
+
+BOOST_AUTO_TEST_SUITE(CommandSchedulerSuite)
+
+BOOST_AUTO_TEST_CASE(CommandSchedulerPriorities)
+{
+	regilo::CommandScheduler scheduler(std::chrono::milliseconds::zero());
+
+	// Keep the worker busy with an "in-flight" command until all commands are queued
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	scheduler.schedule(Priority::Scan, [&started, released] () { started.set_value(); released.wait(); });
+	started.get_future().wait();
+
+	std::mutex mutex;
+	std::vector<Priority> order;
+	auto record = [&mutex, &order] (Priority priority)
+	{
+		return [&mutex, &order, priority] ()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			order.push_back(priority);
+		};
+	};
+
+	scheduler.schedule(Priority::Telemetry, record(Priority::Telemetry));
+	scheduler.schedule(Priority::Scan, record(Priority::Scan));
+	std::future<void> last = scheduler.schedule(Priority::Telemetry, record(Priority::Telemetry));
+	scheduler.schedule(Priority::Motor, record(Priority::Motor));
+	scheduler.schedule(Priority::Safety, record(Priority::Safety));
+
+	BOOST_CHECK_EQUAL(scheduler.getQueueDepth(), 5);
+
+	regilo::CommandScheduler::Stats stats = scheduler.getStats();
+	BOOST_CHECK_EQUAL(stats.depth.at(std::size_t(Priority::Telemetry)), 2);
+	BOOST_CHECK_EQUAL(stats.maxDepth.at(std::size_t(Priority::Telemetry)), 2);
+
+	release.set_value();
+	last.wait();
+	scheduler.stop();
+
+	std::vector<Priority> correctOrder = { Priority::Safety, Priority::Motor, Priority::Scan, Priority::Telemetry, Priority::Telemetry };
+	BOOST_CHECK(order == correctOrder);
+
+	stats = scheduler.getStats();
+	BOOST_CHECK_EQUAL(scheduler.getQueueDepth(), 0);
+	BOOST_CHECK_EQUAL(stats.executed.at(std::size_t(Priority::Scan)), 2);
+	BOOST_CHECK_EQUAL(stats.executed.at(std::size_t(Priority::Telemetry)), 2);
+	BOOST_CHECK_EQUAL(stats.promoted, 0);
+}
+
+BOOST_AUTO_TEST_CASE(CommandSchedulerAging)
+{
+	regilo::CommandScheduler scheduler(std::chrono::milliseconds(20));
+
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	scheduler.schedule(Priority::Scan, [&started, released] () { started.set_value(); released.wait(); });
+	started.get_future().wait();
+
+	std::mutex mutex;
+	std::vector<Priority> order;
+
+	scheduler.schedule(Priority::Telemetry, [&mutex, &order] ()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		order.push_back(Priority::Telemetry);
+	});
+
+	// After three aging intervals the telemetry has the highest priority, so it precedes a new motor command
+	std::this_thread::sleep_for(std::chrono::milliseconds(80));
+
+	std::future<void> last = scheduler.schedule(Priority::Motor, [&mutex, &order] ()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		order.push_back(Priority::Motor);
+	});
+
+	release.set_value();
+	last.wait();
+
+	BOOST_REQUIRE_EQUAL(order.size(), 2);
+	BOOST_CHECK(order.at(0) == Priority::Telemetry);
+	BOOST_CHECK(order.at(1) == Priority::Motor);
+
+	regilo::CommandScheduler::Stats stats = scheduler.getStats();
+	BOOST_CHECK_EQUAL(stats.promoted, 1);
+	BOOST_CHECK(stats.maxWait >= std::chrono::milliseconds(80));
+}
+
+BOOST_AUTO_TEST_CASE(CommandSchedulerLatest)
+{
+	regilo::CommandScheduler scheduler(std::chrono::milliseconds::zero());
+
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	scheduler.schedule(Priority::Scan, [&started, released] () { started.set_value(); released.wait(); });
+	started.get_future().wait();
+
+	std::mutex mutex;
+	std::vector<int> values;
+	auto record = [&mutex, &values] (int value)
+	{
+		return [&mutex, &values, value] ()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			values.push_back(value);
+		};
+	};
+
+	std::future<void> first = scheduler.scheduleLatest(Priority::Motor, "motor", record(1));
+	scheduler.schedule(Priority::Motor, record(2));
+	std::future<void> second = scheduler.scheduleLatest(Priority::Motor, "motor", record(3));
+	std::future<void> last = scheduler.scheduleLatest(Priority::Telemetry, "telemetry", record(4));
+	scheduler.scheduleLatest(Priority::Motor, "motor", record(5));
+
+	BOOST_CHECK_EQUAL(scheduler.getQueueDepth(), 3);
+	BOOST_CHECK_EQUAL(scheduler.getStats().replaced, 2);
+	BOOST_CHECK_THROW(first.get(), std::future_error);
+	BOOST_CHECK_THROW(second.get(), std::future_error);
+
+	release.set_value();
+	last.wait();
+	scheduler.stop();
+
+	std::vector<int> correctValues = { 2, 5, 4 };
+	BOOST_CHECK(values == correctValues);
+
+	BOOST_CHECK_THROW(scheduler.scheduleLatest(Priority::Motor, "", [] () {}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(CommandSchedulerLatestSafety)
+{
+	regilo::CommandScheduler scheduler(std::chrono::milliseconds::zero());
+
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	scheduler.schedule(Priority::Scan, [&started, released] () { started.set_value(); released.wait(); });
+	started.get_future().wait();
+
+	std::mutex mutex;
+	std::vector<std::string> commands;
+	auto record = [&mutex, &commands] (const std::string& command)
+	{
+		return [&mutex, &commands, command] ()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			commands.push_back(command);
+		};
+	};
+
+	// The stop drops the waiting motor command, the motor command does not drop the waiting stop
+	std::future<void> motor = scheduler.scheduleLatest(Priority::Motor, "motor", record("go"));
+	std::future<void> stop = scheduler.scheduleLatest(Priority::Safety, "motor", record("stop"));
+	std::future<void> last = scheduler.scheduleLatest(Priority::Motor, "motor", record("turn"));
+
+	BOOST_CHECK_EQUAL(scheduler.getQueueDepth(), 2);
+	BOOST_CHECK_THROW(motor.get(), std::future_error);
+
+	release.set_value();
+	last.wait();
+	scheduler.stop();
+
+	BOOST_CHECK_NO_THROW(stop.get());
+
+	std::vector<std::string> correctCommands = { "stop", "turn" };
+	BOOST_CHECK(commands == correctCommands);
+}
+
+BOOST_AUTO_TEST_CASE(CommandSchedulerFutures)
+{
+	regilo::CommandScheduler scheduler;
+
+	std::future<int> value = scheduler.schedule(Priority::Telemetry, [] () { return 42; });
+	BOOST_CHECK_EQUAL(value.get(), 42);
+
+	std::future<void> error = scheduler.schedule(Priority::Motor, [] () { throw std::runtime_error("Failed command"); });
+	BOOST_CHECK_THROW(error.get(), std::runtime_error);
+
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	std::future<void> inFlight = scheduler.schedule(Priority::Scan, [&started, released] () { started.set_value(); released.wait(); });
+	started.get_future().wait();
+
+	std::future<int> discarded = scheduler.schedule(Priority::Scan, [] () { return 1; });
+
+	std::thread releaseThread([&release] ()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		release.set_value();
+	});
+
+	scheduler.stop();
+	if(releaseThread.joinable()) releaseThread.join();
+
+	BOOST_CHECK_NO_THROW(inFlight.get());
+	BOOST_CHECK_THROW(discarded.get(), std::future_error);
+	BOOST_CHECK_THROW(scheduler.schedule(Priority::Safety, [] () {}), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(CommandSchedulerPeriodic)
+{
+	regilo::CommandScheduler scheduler(std::chrono::milliseconds::zero());
+
+	BOOST_CHECK_THROW(scheduler.schedulePeriodic(Priority::Telemetry, std::chrono::milliseconds::zero(), [] () {}), std::invalid_argument);
+
+	std::atomic<int> polls(0);
+	std::size_t id = scheduler.schedulePeriodic(Priority::Telemetry, std::chrono::milliseconds(10), [&polls] () { polls++; });
+	std::size_t failing = scheduler.schedulePeriodic(Priority::Telemetry, std::chrono::milliseconds(10), [] () { throw std::runtime_error("Failed poll"); });
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	BOOST_CHECK_GE(polls.load(), 3);
+
+	// A busy worker skips the runs instead of piling them up
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	std::future<void> scan = scheduler.schedule(Priority::Scan, [&started, released] () { started.set_value(); released.wait(); });
+	started.get_future().wait();
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	int busyCount = polls;
+	release.set_value();
+	scan.wait();
+	scheduler.schedule(Priority::Telemetry, [] () {}).wait();
+
+	regilo::CommandScheduler::Stats stats = scheduler.getStats();
+	BOOST_CHECK_LE(polls.load(), busyCount + 1);
+	BOOST_CHECK_GE(stats.skipped, 10);
+	BOOST_CHECK_GT(stats.failed, 0);
+
+	BOOST_CHECK(scheduler.cancelPeriodic(id));
+	BOOST_CHECK(!scheduler.cancelPeriodic(id));
+	BOOST_CHECK(scheduler.cancelPeriodic(failing));
+
+	// The run in flight finishes before the next command
+	scheduler.schedule(Priority::Telemetry, [] () {}).wait();
+	int count = polls;
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	BOOST_CHECK_EQUAL(polls.load(), count);
+	BOOST_CHECK_EQUAL(scheduler.getQueueDepth(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
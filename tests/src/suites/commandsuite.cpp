@@ -0,0 +1,91 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/commandbuffer.hpp"
+#include "regilo/commanddescriptor.hpp"
+#include "regilo/hokuyocontroller.hpp"
+#include "regilo/neatocontroller.hpp"
+
+BOOST_AUTO_TEST_SUITE(CommandSuite)
+
+BOOST_AUTO_TEST_CASE(CommandBufferAppend)
+{
+	regilo::CommandBuffer buffer;
+	BOOST_CHECK(buffer.empty());
+
+	buffer.append("cmd");
+	buffer.append(' ');
+	buffer.append(-42, 0);
+	buffer.append(' ');
+	buffer.append(7, 3);
+	buffer.append(' ');
+	buffer.append(12345, 2);
+	BOOST_CHECK_EQUAL(buffer.str(), "cmd -42 007 12345");
+
+	std::ostringstream stream;
+	stream << buffer;
+	BOOST_CHECK_EQUAL(stream.str(), buffer.str());
+
+	buffer.clear();
+	BOOST_CHECK_EQUAL(buffer.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(CommandBufferOverflow)
+{
+	regilo::CommandBuffer buffer(std::string(regilo::CommandBuffer::CAPACITY - 1, 'x'));
+	BOOST_CHECK_NO_THROW(buffer.append('x'));
+	BOOST_CHECK_THROW(buffer.append('x'), std::length_error);
+	BOOST_CHECK_THROW(regilo::CommandBuffer(std::string(regilo::CommandBuffer::CAPACITY + 1, 'x')), std::length_error);
+}
+
+BOOST_AUTO_TEST_CASE(CommandDescriptorSerialize)
+{
+	constexpr regilo::CommandDescriptor<' ', regilo::command::Int<>, regilo::command::Text> descriptor("cmd");
+	BOOST_CHECK_EQUAL(descriptor(-5, "on").str(), "cmd -5 on");
+
+	BOOST_CHECK_EQUAL(regilo::NeatoSerialController::CMD_SET_MOTOR(100, -100, 50).str(), "setmotor 100 -100 50");
+	BOOST_CHECK_EQUAL(regilo::NeatoSerialController::CMD_TEST_MODE("on").str(), "testmode on");
+	BOOST_CHECK_EQUAL(regilo::NeatoSerialController::CMD_GET_LDS_SCAN.str(), "getldsscan");
+
+	regilo::CommandBuffer buffer;
+	regilo::HokuyoSerialController::CMD_GET_SCAN.serialize(buffer, 0, 768, 1);
+	BOOST_CHECK_EQUAL(buffer.str(), "G00076801");
+
+	regilo::HokuyoSerialController::CMD_GET_SCAN.serialize(buffer, 44, 725, 10);
+	BOOST_CHECK_EQUAL(buffer.str(), "G04472510");
+}
+
+BOOST_AUTO_TEST_CASE(CommandFormattedLong)
+{
+	regilo::NeatoSerialController controller;
+
+	std::string text(2 * regilo::CommandBuffer::CAPACITY, 'x');
+	BOOST_CHECK_EQUAL(controller.createFormattedCommand("cmd %s %d", text.c_str(), 5), "cmd " + text + " 5");
+	BOOST_CHECK_EQUAL(controller.createFormattedCommand("cmd %03d", 5), "cmd 005");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,185 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/controllermanager.hpp"
+#include "regilo/neatocontroller.hpp"
+#include "regilo/timeouterror.hpp"
+
+#include "simulators/socketsimulator.hpp"
+
+BOOST_AUTO_TEST_SUITE(ControllerManagerSuite)
+
+BOOST_AUTO_TEST_CASE(ControllerManagerThreads)
+{
+	regilo::ControllerManager manager(3);
+	BOOST_CHECK_EQUAL(manager.getThreadCount(), 3);
+
+	std::shared_ptr<regilo::NeatoSocketController> controller = manager.createController<regilo::NeatoSocketController>();
+	BOOST_CHECK(&controller->getIoService() == &manager.getIoService());
+	BOOST_CHECK_EQUAL(controller->RESPONSE_END, std::string(1, 0x1a));
+
+	controller.reset();
+	manager.stop();
+	BOOST_CHECK_EQUAL(manager.getThreadCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ControllerManagerAsyncScans)
+{
+	const std::size_t deviceCount = 4;
+	const std::size_t scanCount = 3;
+
+	std::string correctScan;
+	std::ifstream dataFile("data/neato-correct-scan.txt");
+	std::getline(dataFile, correctScan, '\0');
+
+	std::string scanCommand = regilo::NeatoSocketController::CMD_GET_LDS_SCAN.str();
+	std::string log = SocketSimulator::createRepeatedLog("data/neato-log-scan-move-time.txt", scanCommand, scanCount);
+
+	std::vector<std::unique_ptr<std::stringstream>> logStreams;
+	std::vector<std::unique_ptr<SocketSimulator>> simulators;
+	std::vector<std::thread> deviceThreads;
+	std::vector<char> deviceStatuses(deviceCount, false);
+
+	for(std::size_t i = 0; i < deviceCount; i++)
+	{
+		logStreams.emplace_back(new std::stringstream(log));
+		simulators.emplace_back(new SocketSimulator(*logStreams.back(), 0));
+		simulators.back()->responseEnd = std::string(1, 0x1a);
+
+		SocketSimulator *simulator = simulators.back().get();
+		char *deviceStatus = &deviceStatuses.at(i);
+		deviceThreads.emplace_back([simulator, deviceStatus] ()
+		{
+			*deviceStatus = simulator->run();
+		});
+	}
+
+	{
+		regilo::ControllerManager manager(2);
+
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::size_t finished = 0;
+
+		std::vector<std::shared_ptr<regilo::NeatoSocketController>> controllers;
+		std::vector<regilo::ScanData> scans(deviceCount);
+		std::vector<std::size_t> scanCounts(deviceCount, 0);
+		std::vector<std::string> firstScans(deviceCount);
+		std::vector<std::function<void(const boost::system::error_code&)>> handlers(deviceCount);
+
+		for(std::size_t i = 0; i < deviceCount; i++)
+		{
+			controllers.push_back(manager.createController<regilo::NeatoSocketController>());
+			controllers.back()->connect(simulators.at(i)->getEndpoint());
+
+			regilo::NeatoSocketController *controller = controllers.back().get();
+			handlers.at(i) = [&, controller, i] (const boost::system::error_code& error)
+			{
+				BOOST_CHECK(!error);
+
+				if(scanCounts.at(i) == 0)
+				{
+					std::ostringstream scanStream;
+					scanStream << scans.at(i);
+					firstScans.at(i) = scanStream.str();
+				}
+
+				if(++scanCounts.at(i) < scanCount && !error) controller->asyncGetScan(scans.at(i), handlers.at(i));
+				else
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					finished++;
+					condition.notify_one();
+				}
+			};
+		}
+
+		for(std::size_t i = 0; i < deviceCount; i++)
+		{
+			controllers.at(i)->asyncGetScan(scans.at(i), handlers.at(i));
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		BOOST_REQUIRE(condition.wait_for(lock, std::chrono::seconds(10), [&finished, deviceCount] () { return finished == deviceCount; }));
+
+		for(std::size_t i = 0; i < deviceCount; i++)
+		{
+			BOOST_CHECK_EQUAL(scanCounts.at(i), scanCount);
+			BOOST_CHECK_EQUAL(firstScans.at(i), correctScan);
+			BOOST_CHECK_EQUAL(scans.at(i).scanId, scanCount - 1);
+			BOOST_CHECK_EQUAL(scans.at(i).size(), regilo::NeatoSocketController::LDS_SCAN_SIZE);
+		}
+
+		controllers.clear();
+	}
+
+	for(std::size_t i = 0; i < deviceCount; i++)
+	{
+		if(deviceThreads.at(i).joinable()) deviceThreads.at(i).join();
+		BOOST_CHECK(deviceStatuses.at(i));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ControllerManagerTimeout)
+{
+	std::stringstream logStream("1$gettime\n$Sunday 13:57:09$");
+	SocketSimulator simulator(logStream, 0);
+
+	regilo::ControllerManager manager(1);
+	std::shared_ptr<regilo::NeatoSocketController> controller = manager.createController<regilo::NeatoSocketController>();
+	controller->connect(simulator.getEndpoint());
+
+	// The simulator does not run, so the blocking command has to be canceled through the shared service
+	controller->timeout = std::chrono::milliseconds(100);
+	BOOST_CHECK_THROW(controller->getTime(), regilo::TimeoutError);
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool finished = false;
+	boost::system::error_code scanError;
+
+	regilo::ScanData data;
+	controller->asyncGetScan(data, [&] (const boost::system::error_code& error)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		scanError = error;
+		finished = true;
+		condition.notify_one();
+	});
+
+	std::unique_lock<std::mutex> lock(mutex);
+	BOOST_REQUIRE(condition.wait_for(lock, std::chrono::seconds(5), [&finished] () { return finished; }));
+	BOOST_CHECK(scanError == boost::asio::error::timed_out);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
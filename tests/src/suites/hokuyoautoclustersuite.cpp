@@ -0,0 +1,65 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <chrono>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/hokuyoautocluster.hpp"
+
+BOOST_AUTO_TEST_SUITE(HokuyoAutoClusterSuite)
+
+BOOST_AUTO_TEST_CASE(HokuyoAutoClusterThroughput)
+{
+	regilo::HokuyoAutoCluster autoCluster;
+	BOOST_CHECK_EQUAL(autoCluster.getThroughput(), 0);
+
+	autoCluster.addTransfer(0, std::chrono::milliseconds(100));
+	autoCluster.addTransfer(1000, std::chrono::milliseconds(0));
+	BOOST_CHECK_EQUAL(autoCluster.getThroughput(), 0);
+
+	autoCluster.addTransfer(1000, std::chrono::milliseconds(100));
+	BOOST_CHECK_CLOSE(autoCluster.getThroughput(), 10000, 1e-9);
+
+	autoCluster.addTransfer(2000, std::chrono::milliseconds(100));
+	BOOST_CHECK_CLOSE(autoCluster.getThroughput(), 12000, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoAutoClusterCount)
+{
+	regilo::HokuyoAutoCluster autoCluster;
+	autoCluster.addTransfer(1200, std::chrono::milliseconds(100));
+
+	// Disabled
+	BOOST_CHECK(!autoCluster.isEnabled());
+	BOOST_CHECK_EQUAL(autoCluster.getClusterCount(682, 2, 1, 13), 0);
+	BOOST_CHECK_THROW(autoCluster.setTargetScanRate(-1), std::invalid_argument);
+
+	// 1200 bytes per scan: 1399 bytes without clusters, 706 bytes with two steps per value
+	autoCluster.setTargetScanRate(10);
+	BOOST_CHECK(autoCluster.isEnabled());
+	BOOST_CHECK_EQUAL(autoCluster.getClusterCount(682, 2, 1, 13), 2);
+	BOOST_CHECK_EQUAL(autoCluster.getClusterCount(100, 2, 1, 13), 1);
+
+	autoCluster.setTargetScanRate(1000);
+	BOOST_CHECK_EQUAL(autoCluster.getClusterCount(682, 3, 2, 23), regilo::HokuyoAutoCluster::MAX_CLUSTER_COUNT);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <chrono>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/hokuyoclock.hpp"
+
+namespace {
+
+regilo::HokuyoClock::TimePoint at(double milliseconds)
+{
+	return regilo::HokuyoClock::TimePoint(std::chrono::duration_cast<regilo::HokuyoClock::TimePoint::duration>(
+		std::chrono::duration<double, std::milli>(milliseconds)));
+}
+
+double toMilliseconds(regilo::HokuyoClock::TimePoint time)
+{
+	return std::chrono::duration<double, std::milli>(time.time_since_epoch()).count();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(HokuyoClockSuite)
+
+BOOST_AUTO_TEST_CASE(HokuyoClockOffset)
+{
+	regilo::HokuyoClock clock;
+	regilo::HokuyoClock::TimePoint time;
+
+	BOOST_CHECK(!clock.isSynchronized());
+	BOOST_CHECK(!clock.toHostTime(0, time));
+	BOOST_CHECK(!clock.addScan(at(0), 0, time));
+
+	// The scanner time 500 is in the middle of the round trip (10000; 10004)
+	clock.addRoundTrip(at(10000), at(10004), 500);
+	BOOST_CHECK(clock.isSynchronized());
+	BOOST_CHECK(clock.getAccuracy() == std::chrono::milliseconds(2));
+
+	BOOST_REQUIRE(clock.toHostTime(600, time));
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 10102, 1e-6);
+
+	// A scan that is received 5 ms after its capture
+	BOOST_REQUIRE(clock.addScan(at(10107), 600, time));
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 10102, 1e-6);
+
+	// A scan cannot be captured after it is received, so the offset is corrected
+	BOOST_REQUIRE(clock.addScan(at(10200), 700, time));
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 10200, 1e-6);
+	BOOST_REQUIRE(clock.toHostTime(800, time));
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 10300, 1e-6);
+
+	clock.reset();
+	BOOST_CHECK(!clock.isSynchronized());
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoClockDrift)
+{
+	regilo::HokuyoClock clock(4);
+	regilo::HokuyoClock::TimePoint time;
+
+	// The host clock runs 100 ppm faster than the scanner clock
+	for(long i = 0; i <= 6; i++)
+	{
+		long deviceTime = i * 60000;
+		double hostTime = 5000 + deviceTime * 1.0001;
+		clock.addRoundTrip(at(hostTime - 1), at(hostTime + 1), deviceTime);
+	}
+
+	BOOST_CHECK_CLOSE(clock.getDrift(), 1e-4, 1e-3);
+
+	BOOST_REQUIRE(clock.toHostTime(420000, time));
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 5000 + 420000 * 1.0001, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoClockDeviceAhead)
+{
+	regilo::HokuyoClock clock(4);
+	regilo::HokuyoClock::TimePoint time;
+
+	clock.addRoundTrip(at(1000), at(1000), 0);
+
+	// The scanner clock runs 50 ms ahead of the model, the scans are received 10 ms after their capture
+	for(long i = 1; i <= 4; i++)
+	{
+		double hostTime = 1000 + i * 100;
+		BOOST_REQUIRE(clock.addScan(at(hostTime + 10), i * 100 + 50, time));
+		BOOST_CHECK_CLOSE(toMilliseconds(time), hostTime + 10, 1e-6);
+	}
+
+	// The scanner clock is back in line, so the correction is undone when the early scans leave the window
+	for(long i = 5; i <= 8; i++)
+	{
+		BOOST_REQUIRE(clock.addScan(at(1000 + i * 100 + 10), i * 100, time));
+	}
+
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 1800, 1e-6);
+	BOOST_REQUIRE(clock.toHostTime(900, time));
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 1900, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoClockWrapAround)
+{
+	regilo::HokuyoClock clock;
+	regilo::HokuyoClock::TimePoint time;
+
+	long range = regilo::HokuyoClock::DEVICE_TIME_RANGE;
+	clock.addRoundTrip(at(1000), at(1000), range - 100);
+
+	// The time stamps continue after the wrap around
+	BOOST_REQUIRE(clock.addScan(at(1300), 100, time));
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 1200, 1e-6);
+
+	// An older time stamp from before the wrap around
+	BOOST_REQUIRE(clock.toHostTime(range - 50, time));
+	BOOST_CHECK_CLOSE(toMilliseconds(time), 1050, 1e-6);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
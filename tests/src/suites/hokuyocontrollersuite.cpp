@@ -19,6 +19,7 @@
  *
  */
 
+#include <cmath>
 #include <iostream>
 #include <mutex>
 #include <sstream>
@@ -178,4 +179,65 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(HokuyoControllerSetScanParameters, HokuyoContro
 	BOOST_CHECK_THROW(controller->setScanParameters(80, 50, 1), std::invalid_argument);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(HokuyoControllerSetScanSector, HokuyoController, HokuyoControllers, HF)
+{
+	HokuyoController *controller = HF::controllers.at(0);
+	regilo::IHokuyoController *iController = controller;
+
+	// The front step is 384 and there are 256 steps in 90 degrees
+	iController->setScanSector(-M_PI / 2, M_PI / 2, 3);
+	BOOST_CHECK_EQUAL(iController->getFromStep(), 128);
+	BOOST_CHECK_EQUAL(iController->getToStep(), 640);
+	BOOST_CHECK_EQUAL(iController->getClusterCount(), 3);
+	BOOST_REQUIRE_EQUAL(controller->getAngleTable()->size(), (640 - 128) / 3 + 1);
+	BOOST_CHECK_CLOSE(controller->getAngleTable()->angles.front(), -M_PI / 2, 1e-9);
+
+	// The sector is clamped to the steps of the scanner
+	iController->setScanSector(-M_PI, M_PI, 1);
+	BOOST_CHECK_EQUAL(iController->getFromStep(), 0);
+	BOOST_CHECK_EQUAL(iController->getToStep(), 768);
+	BOOST_CHECK_THROW(iController->setScanSector(0.5, -0.5, 1), std::invalid_argument);
+
+	// The cluster count is chosen automatically if the target scan rate is set (see HokuyoControllerAutoCluster)
+	iController->setTargetScanRate(10);
+	iController->setScanParameters(100, 200, 5);
+	BOOST_CHECK_EQUAL(iController->getFromStep(), 100);
+	BOOST_CHECK_EQUAL(iController->getClusterCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoControllerAutoCluster)
+{
+	// The second scan is clustered after the throughput of the first one is measured
+	std::stringstream logStream("1$G04405301\n$0\n" + std::string(20, '0') + "$G04405399\n$0\n00$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = "\n\n";
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	regilo::HokuyoSocketController controller;
+	controller.connect(simulator.getEndpoint());
+
+	controller.setScanParameters(44, 53, 1);
+	BOOST_CHECK_EQUAL(controller.getThroughput(), 0);
+
+	// No link can transfer a scan at this rate, so the maximal cluster count is chosen
+	controller.setTargetScanRate(1e9);
+
+	regilo::ScanData data = controller.getScan();
+	BOOST_CHECK_EQUAL(data.size(), 10);
+	BOOST_CHECK_GT(controller.getThroughput(), 0);
+	BOOST_CHECK_EQUAL(controller.getClusterCount(), regilo::HokuyoAutoCluster::MAX_CLUSTER_COUNT);
+	BOOST_CHECK_EQUAL(controller.getAngleTable()->size(), 1);
+
+	data = controller.getScan();
+	BOOST_CHECK_EQUAL(data.size(), 1);
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/hokuyogeometry.hpp"
+
+BOOST_AUTO_TEST_SUITE(HokuyoGeometrySuite)
+
+BOOST_AUTO_TEST_CASE(HokuyoGeometryDefault)
+{
+	regilo::HokuyoGeometry geometry;
+	BOOST_CHECK(geometry.isValid());
+	BOOST_CHECK_EQUAL(geometry.getMaxStep(), 768);
+	BOOST_CHECK_CLOSE(geometry.getResolution(), M_PI / 512, 1e-9);
+	BOOST_CHECK_CLOSE(geometry.getStartAngle(), -135 * M_PI / 180, 1e-9);
+
+	BOOST_CHECK_EQUAL(geometry.getStep(0), 384);
+	BOOST_CHECK_EQUAL(geometry.getStep(M_PI / 512 * 10.4), 394);
+	BOOST_CHECK_EQUAL(geometry.getStep(-M_PI), 0);
+	BOOST_CHECK_EQUAL(geometry.getStep(M_PI), 768);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoGeometryParameters)
+{
+	regilo::HokuyoGeometry geometry;
+	geometry.setParameters({
+		{ "MODL", "UTM-30LX" }, { "DMIN", "23" }, { "DMAX", "60000" }, { "ARES", "1440" },
+		{ "AMIN", "0" }, { "AMAX", "1080" }, { "AFRT", "540" }, { "SCAN", "2400" }
+	});
+
+	BOOST_CHECK(geometry.isValid());
+	BOOST_CHECK_EQUAL(geometry.validFromStep, 0);
+	BOOST_CHECK_EQUAL(geometry.validToStep, 1080);
+	BOOST_CHECK_EQUAL(geometry.getMaxStep(), 1080);
+	BOOST_CHECK_EQUAL(geometry.minDistance, 23);
+	BOOST_CHECK_EQUAL(geometry.maxDistance, 60000);
+	BOOST_CHECK_EQUAL(geometry.scanSpeed, 2400);
+	BOOST_CHECK_CLOSE(geometry.getStartAngle(), -135 * M_PI / 180, 1e-9);
+
+	BOOST_CHECK_EQUAL(geometry.getParameters().size(), 7);
+	BOOST_CHECK_EQUAL(geometry.getParameters()["ARES"], "1440");
+
+	geometry.validFromStep = 2000;
+	BOOST_CHECK(!geometry.isValid());
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoGeometryVersionInfo)
+{
+	regilo::HokuyoGeometry geometry;
+	geometry.setVersionInfo({ { "FIRM", "3.3.00,08/04/16(20-5600[mm],240[deg],50-700[step],750[rpm])" } });
+
+	BOOST_CHECK_EQUAL(geometry.minDistance, 20);
+	BOOST_CHECK_EQUAL(geometry.maxDistance, 5600);
+	BOOST_CHECK_EQUAL(geometry.validFromStep, 50);
+	BOOST_CHECK_EQUAL(geometry.validToStep, 700);
+	BOOST_CHECK_EQUAL(geometry.scanSpeed, 750);
+	BOOST_CHECK_EQUAL(geometry.stepsPerRevolution, 1024);
+
+	regilo::HokuyoGeometry defaultGeometry;
+	geometry = defaultGeometry;
+	geometry.setVersionInfo({ { "FIRM", "1.24.01(01/Dec/2008)" } });
+	BOOST_CHECK(geometry.getParameters() == defaultGeometry.getParameters());
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoGeometryCache)
+{
+	BOOST_CHECK_EQUAL(regilo::HokuyoGeometry::getCachePath("cache", "H1 2/3"), "cache/hokuyo-H1_2_3.txt");
+	BOOST_CHECK_EQUAL(regilo::HokuyoGeometry::getCachePath("cache/", "H123"), "cache/hokuyo-H123.txt");
+
+	std::string path = regilo::HokuyoGeometry::getCachePath(".", "geometry-test");
+	std::remove(path.c_str());
+
+	regilo::HokuyoGeometry geometry;
+	BOOST_CHECK(!geometry.load(path));
+
+	geometry.stepsPerRevolution = 1440;
+	geometry.validToStep = 1080;
+	geometry.frontStep = 540;
+	BOOST_REQUIRE(geometry.save(path));
+
+	regilo::HokuyoGeometry loadedGeometry;
+	BOOST_REQUIRE(loadedGeometry.load(path));
+	BOOST_CHECK(loadedGeometry.getParameters() == geometry.getParameters());
+
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
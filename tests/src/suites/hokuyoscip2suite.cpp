@@ -0,0 +1,351 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/hokuyoscip2controller.hpp"
+
+#include "simulators/socketsimulator.hpp"
+
+namespace {
+
+std::string withChecksum(const std::string& line)
+{
+	return line + regilo::HokuyoScip2ScanParser::checksum(line.data(), line.data() + line.size());
+}
+
+// The checksum of an information line does not include the semicolon
+std::string infoLine(const std::string& line)
+{
+	return line + ';' + regilo::HokuyoScip2ScanParser::checksum(line.data(), line.data() + line.size());
+}
+
+std::string encode(long value, std::size_t encoding)
+{
+	std::string characters;
+	for(std::size_t i = encoding; i > 0; i--) characters += char(((value >> (6 * (i - 1))) & 0x3f) + 0x30);
+
+	return characters;
+}
+
+// The response of GD/GS without the echo and the final empty line
+std::string createScanResponse(const std::vector<long>& distances, std::size_t encoding, long timestamp)
+{
+	std::string encoded;
+	for(long distance : distances) encoded += encode(distance, encoding);
+
+	std::string response = withChecksum("00") + '\n' + withChecksum(encode(timestamp, 4));
+	for(std::size_t i = 0; i < encoded.size(); i += 64)
+	{
+		response += '\n' + withChecksum(encoded.substr(i, 64));
+	}
+
+	return response;
+}
+
+bool parseInParts(regilo::ScanParser& parser, const std::string& response, std::size_t partSize, regilo::ScanData& data)
+{
+	parser.begin(data);
+	for(std::size_t i = 0; i < response.size(); i += partSize)
+	{
+		const char *begin = response.data() + i;
+		parser.parse(begin, begin + std::min(partSize, response.size() - i));
+	}
+
+	return parser.end();
+}
+
+std::vector<long> createDistances(std::size_t count)
+{
+	std::vector<long> distances;
+	for(std::size_t i = 0; i < count; i++) distances.push_back(i % 50 == 0 ? 1 : long(100 + i * 37));
+
+	return distances;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(HokuyoScip2Suite)
+
+BOOST_AUTO_TEST_CASE(HokuyoScip2Parser)
+{
+	std::vector<long> distances = createDistances(100);
+
+	for(std::size_t encoding : { 2, 3 })
+	{
+		std::string response = createScanResponse(distances, encoding, 123456);
+
+		for(std::size_t partSize : { 1, 5, 64, 10000 })
+		{
+			regilo::HokuyoScip2ScanParser parser;
+			parser.setEncoding(encoding);
+			parser.setParameters(0, 1, 0, 1000, 20, 0.01, -1, nullptr);
+
+			regilo::ScanData data;
+			BOOST_REQUIRE(parseInParts(parser, response, partSize, data));
+			BOOST_REQUIRE_EQUAL(data.size(), distances.size());
+			BOOST_CHECK_EQUAL(parser.getTimestamp(), 123456);
+			BOOST_CHECK_EQUAL(parser.getCorruptLines(), 0);
+
+			for(std::size_t i = 0; i < data.size(); i++)
+			{
+				BOOST_CHECK_EQUAL(data[i].id, int(i));
+				BOOST_CHECK_CLOSE(data[i].angle, i * 0.01 - 1, 1e-9);
+
+				if(distances[i] < 20)
+				{
+					BOOST_CHECK(data[i].error);
+					BOOST_CHECK_EQUAL(data[i].errorCode, distances[i]);
+				}
+				else BOOST_CHECK_EQUAL(data[i].distance, (encoding == 2 ? distances[i] & 0xfff : distances[i]));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoScip2ParserChecksum)
+{
+	std::vector<long> distances = createDistances(100);
+	std::string response = createScanResponse(distances, 3, 0);
+
+	// A distance in the second data line (values 21 to 42, the value 42 continues on the third line)
+	std::size_t secondLine = response.find('\n', response.find('\n', response.find('\n') + 1) + 1) + 1;
+	response[secondLine + 10]++;
+
+	regilo::HokuyoScip2ScanParser parser;
+	parser.setParameters(0, 1, 0, 1000, 20, 0.01, -1, nullptr);
+
+	regilo::ScanData data;
+	BOOST_REQUIRE(parseInParts(parser, response, 7, data));
+	BOOST_REQUIRE_EQUAL(data.size(), distances.size());
+	BOOST_CHECK_EQUAL(parser.getCorruptLines(), 1);
+
+	for(std::size_t i = 0; i < data.size(); i++)
+	{
+		bool corrupt = (i >= 21 && i <= 42);
+		if(corrupt) BOOST_CHECK_EQUAL(data[i].errorCode, regilo::HokuyoScip2ScanParser::CHECKSUM_ERROR_CODE);
+		else if(distances[i] >= 20) BOOST_CHECK_EQUAL(data[i].distance, distances[i]);
+	}
+
+	// A wrong status fails the scan
+	std::string failedResponse = withChecksum("10") + '\n' + withChecksum(encode(0, 4));
+	BOOST_CHECK(!parseInParts(parser, failedResponse, 3, data));
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoScip2ParserMinDistance)
+{
+	std::string response = createScanResponse({ 10, 25, 40 }, 3, 0);
+
+	// The values below the minimal distance of the model are error codes
+	regilo::HokuyoScip2ScanParser parser;
+	parser.setParameters(0, 1, 0, 1000, 30, 0.01, -1, nullptr);
+
+	regilo::ScanData data;
+	BOOST_REQUIRE(parseInParts(parser, response, 4, data));
+	BOOST_REQUIRE_EQUAL(data.size(), 3);
+
+	BOOST_CHECK(data[0].error);
+	BOOST_CHECK_EQUAL(data[0].errorCode, 10);
+	BOOST_CHECK(data[1].error);
+	BOOST_CHECK_EQUAL(data[1].errorCode, 25);
+	BOOST_CHECK(!data[2].error);
+	BOOST_CHECK_EQUAL(data[2].distance, 40);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoScip2Controller)
+{
+	typedef regilo::HokuyoScip2SocketController Controller;
+
+	std::vector<long> distances(725 - 44 + 1, 5000);
+	distances.insert(distances.begin(), 44, 0);
+
+	std::string version = withChecksum("00") + '\n' + infoLine("VEND:Hokuyo Automatic Co.,Ltd.") + '\n'
+						  + infoLine("PROD:SOKUIKI Sensor URG-04LX") + '\n' + "BROK:broken;0";
+
+	std::stringstream logStream("1$BM\n$" + withChecksum("00") + "$VV\n$" + version
+								+ "$GD0000072501\n$" + createScanResponse(distances, 3, 42)
+								+ "$GS0044004801\n$" + createScanResponse({ 300, 400, 500, 600, 700 }, 2, 43) + "$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = "\n\n";
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	{
+		Controller controller;
+		controller.connect(simulator.getEndpoint());
+
+		controller.setLaser(true);
+		BOOST_CHECK(controller.getLaser());
+
+		std::map<std::string, std::string> versionInfo = controller.getVersionInfo();
+		BOOST_CHECK_EQUAL(versionInfo.size(), 2);
+		BOOST_CHECK_EQUAL(versionInfo["VEND"], "Hokuyo Automatic Co.,Ltd.");
+		BOOST_CHECK_EQUAL(versionInfo["PROD"], "SOKUIKI Sensor URG-04LX");
+
+		controller.setScanParameters(0, 725, 1);
+		regilo::ScanData data = controller.getScan();
+		BOOST_CHECK_EQUAL(data.size(), 725 - 44 + 1);
+		BOOST_CHECK_EQUAL(data.front().distance, 5000);
+		BOOST_CHECK(data.angleTable == controller.getAngleTable());
+		BOOST_CHECK_EQUAL(controller.getCorruptLines(), 0);
+
+		controller.setEncoding(Controller::Encoding::TwoCharacters);
+		controller.setScanParameters(44, 48, 1);
+		data = controller.getScan();
+		BOOST_REQUIRE_EQUAL(data.size(), 5);
+		BOOST_CHECK_EQUAL(data.back().distance, 700);
+	}
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoScip2ControllerClock)
+{
+	typedef regilo::HokuyoScip2SocketController Controller;
+
+	std::vector<long> distances(725 - 44 + 1, 5000);
+	distances.insert(distances.begin(), 44, 0);
+
+	std::string time = withChecksum("00") + '\n' + withChecksum(encode(1000, 4));
+	std::stringstream logStream("1$TM0\n$" + withChecksum("00") + "$TM1\n$" + time + "$TM1\n$" + time
+								+ "$TM2\n$" + withChecksum("00") + "$GD0000076801\n$" + createScanResponse(distances, 3, 1000) + "$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = "\n\n";
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	{
+		Controller controller;
+		controller.connect(simulator.getEndpoint());
+
+		BOOST_REQUIRE(controller.synchronizeClock(2));
+		BOOST_CHECK(controller.getClock().isSynchronized());
+
+		// The scan is captured at the same scanner time as the synchronization
+		std::chrono::steady_clock::time_point beforeScan = std::chrono::steady_clock::now();
+		regilo::ScanData data = controller.getScan();
+		BOOST_CHECK_EQUAL(data.size(), 725 - 44 + 1);
+		BOOST_CHECK(data.steadyTime < beforeScan);
+	}
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoScip2ControllerClockError)
+{
+	typedef regilo::HokuyoScip2SocketController Controller;
+
+	// The response to TM1 never ends, so the time adjust mode is left after the timeout
+	std::string status = withChecksum("00") + "\n\n";
+	std::stringstream logStream("1$BM\n$" + status + "$TM0\n$" + status + "$TM1\n$" + withChecksum("00") + '\n'
+								+ "$TM2\n$" + status + "$BM\n$" + status + "$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = "";
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	{
+		Controller controller;
+		controller.connect(simulator.getEndpoint());
+		controller.setLaser(true);
+
+		controller.timeout = std::chrono::milliseconds(200);
+		BOOST_CHECK_THROW(controller.synchronizeClock(2), regilo::TimeoutError);
+		BOOST_CHECK(!controller.getClock().isSynchronized());
+	}
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+}
+
+BOOST_AUTO_TEST_CASE(HokuyoScip2ControllerGeometry)
+{
+	typedef regilo::HokuyoScip2SocketController Controller;
+
+	std::string version = withChecksum("00") + '\n' + infoLine("PROD:SOKUIKI Sensor TOP-URG UTM-30LX") + '\n'
+						  + infoLine("SERI:H0000001");
+	std::string parameters = withChecksum("00") + '\n' + infoLine("MODL:UTM-30LX") + '\n' + infoLine("DMIN:23") + '\n'
+							 + infoLine("DMAX:60000") + '\n' + infoLine("ARES:1440") + '\n' + infoLine("AMIN:0") + '\n'
+							 + infoLine("AMAX:1080") + '\n' + infoLine("AFRT:540") + '\n' + infoLine("SCAN:2400");
+
+	// The second load reads the cached geometry, so PP is not sent again
+	std::stringstream logStream("1$VV\n$" + version + "$PP\n$" + parameters + "$VV\n$" + version + "$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = "\n\n";
+
+	std::string cachePath = regilo::HokuyoGeometry::getCachePath(".", "H0000001");
+	std::remove(cachePath.c_str());
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	{
+		Controller controller;
+		controller.connect(simulator.getEndpoint());
+
+		BOOST_CHECK_EQUAL(controller.getAngleTable()->size(), 725 - 44 + 1);
+
+		BOOST_REQUIRE(controller.loadGeometry("."));
+		BOOST_CHECK_EQUAL(controller.getGeometry().getMaxStep(), 1080);
+		BOOST_CHECK_EQUAL(controller.getAngleTable()->size(), 1081);
+		BOOST_CHECK_CLOSE(controller.getAngleTable()->angles.front(), -135 * M_PI / 180, 1e-9);
+
+		controller.setGeometry(regilo::HokuyoGeometry());
+		BOOST_CHECK_EQUAL(controller.getAngleTable()->size(), 725 - 44 + 1);
+
+		BOOST_REQUIRE(controller.loadGeometry("."));
+		BOOST_CHECK_EQUAL(controller.getGeometry().stepsPerRevolution, 1440);
+		BOOST_CHECK_EQUAL(controller.getAngleTable()->size(), 1081);
+
+		regilo::HokuyoGeometry invalidGeometry;
+		invalidGeometry.stepsPerRevolution = 0;
+		BOOST_CHECK_THROW(controller.setGeometry(invalidGeometry), std::invalid_argument);
+	}
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+
+	std::remove(cachePath.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
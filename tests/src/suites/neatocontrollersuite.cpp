@@ -19,6 +19,7 @@
  *
  */
 
+#include <chrono>
 #include <iostream>
 #include <mutex>
 #include <sstream>
@@ -163,6 +164,22 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(NeatoControllerScanFromLog, NeatoController, Ne
 	BOOST_CHECK_EQUAL(scanStream.str(), NF::correctScan);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(NeatoControllerScanFromLogIntoData, NeatoController, NeatoControllers, NF)
+{
+	NeatoController *controller = NF::controllers.at(1);
+
+	regilo::ScanData scanData(10, 10);
+	scanData.resize(400);
+	std::size_t capacity = scanData.capacity();
+
+	controller->getScan(scanData, false);
+	std::ostringstream scanStream;
+	scanStream << scanData;
+
+	BOOST_CHECK_EQUAL(scanStream.str(), NF::correctScan);
+	BOOST_CHECK_EQUAL(scanData.capacity(), capacity);
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(NeatoControllerScanFromTimedLog, NeatoController, NeatoControllers, NF)
 {
 	NeatoController *controller = NF::controllers.at(0);
@@ -184,4 +201,263 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(NeatoControllerWrongHeader, NeatoController, Ne
 	BOOST_CHECK(scanData.empty());
 }
 
+BOOST_AUTO_TEST_CASE(NeatoControllerResume)
+{
+	regilo::NeatoSocketController controller;
+	controller.reconnectPolicy.maxAttempts = 5;
+	controller.reconnectPolicy.initialDelay = std::chrono::milliseconds(10);
+
+	{
+		std::stringstream logStream("1$testmode on\n$\n$setldsrotation on\n$\n$");
+		SocketSimulator simulator(logStream, 12345);
+		simulator.responseEnd = std::string(1, 0x1a);
+
+		bool deviceStatus = false;
+		std::thread deviceThread([&simulator, &deviceStatus] ()
+		{
+			deviceStatus = simulator.run();
+		});
+
+		controller.connect(simulator.getEndpoint());
+		controller.setTestMode(true);
+		controller.setLdsRotation(true);
+
+		if(deviceThread.joinable()) deviceThread.join();
+		BOOST_CHECK(deviceStatus);
+	}
+
+	// The new device expects the modes to be turned on again before the next command
+	std::stringstream logStream("1$testmode on\n$\n$setldsrotation on\n$\n$gettime\n$Sunday 13:57:09$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = std::string(1, 0x1a);
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	BOOST_CHECK_EQUAL(controller.getTime(), "Sunday 13:57:09");
+	BOOST_CHECK_EQUAL(controller.getConnectionStats().reconnects, 1);
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+}
+
+BOOST_AUTO_TEST_CASE(NeatoControllerMotorCoalescing)
+{
+	std::stringstream logStream("1$setmotor 1 1 10\n$\n$setmotor 4 4 40\n$\n$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = std::string(1, 0x1a);
+
+	regilo::NeatoSocketController controller;
+	controller.connect(simulator.getEndpoint());
+	controller.setMotorCoalescing(true);
+
+	// The simulator does not run yet, so the first setmotor stays in flight
+	std::thread firstThread([&controller] ()
+	{
+		controller.setMotor(1, 1, 10);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	controller.setMotor(2, 2, 20);
+	controller.setMotor(3, 3, 30);
+	controller.setMotor(4, 4, 40);
+
+	BOOST_CHECK_EQUAL(controller.getDroppedMotorCommands(), 2);
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	if(firstThread.joinable()) firstThread.join();
+	if(deviceThread.joinable()) deviceThread.join();
+
+	BOOST_CHECK(deviceStatus);
+	BOOST_CHECK_EQUAL(controller.getDroppedMotorCommands(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(NeatoControllerMotorDuringScan)
+{
+	std::string scan = "AngleInDegrees,DistInMM,Intensity,ErrorCodeHEX\n0,100,10,0\nROTATION_SPEED,5.00\n";
+
+	// Only the latest setmotor follows the scan
+	std::stringstream logStream("1$getldsscan\n$" + scan + "$setmotor 3 3 30\n$\n$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = std::string(1, 0x1a);
+
+	regilo::NeatoSocketController controller;
+	controller.connect(simulator.getEndpoint());
+	controller.setMotorCoalescing(true);
+
+	// The simulator does not run yet, so the scan stays in flight
+	regilo::ScanData data;
+	std::thread scanThread([&controller, &data] ()
+	{
+		controller.getScan(data);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	controller.setMotor(1, 1, 10);
+	controller.setMotor(2, 2, 20);
+	controller.setMotor(3, 3, 30);
+
+	BOOST_CHECK_EQUAL(controller.getDroppedMotorCommands(), 2);
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	if(scanThread.joinable()) scanThread.join();
+	if(deviceThread.joinable()) deviceThread.join();
+
+	BOOST_CHECK(deviceStatus);
+	BOOST_CHECK_EQUAL(data.size(), 1);
+	BOOST_CHECK_EQUAL(controller.getDroppedMotorCommands(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(NeatoControllerMotorCoalescingError)
+{
+	regilo::NeatoSocketController controller;
+	controller.setMotorCoalescing(true);
+
+	// A failed send must not leave the coalescing in the sending state
+	BOOST_CHECK_THROW(controller.setMotor(1, 1, 10), boost::system::system_error);
+	BOOST_CHECK_THROW(controller.setMotor(2, 2, 20), boost::system::system_error);
+	BOOST_CHECK_EQUAL(controller.getDroppedMotorCommands(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(NeatoControllerDuplicateScans, NeatoController, NeatoControllers, NF)
+{
+	typedef typename NeatoController::DuplicatePolicy DuplicatePolicy;
+
+	std::string scanCommand = NeatoController::CMD_GET_LDS_SCAN.str();
+	std::stringstream logStream(Simulator::createRepeatedLog(NF::logPath, scanCommand, 6));
+
+	NeatoController controller(logStream);
+
+	// Not detected by default
+	regilo::ScanData data;
+	controller.getScan(data, false);
+	BOOST_CHECK(!data.duplicate);
+	BOOST_CHECK_EQUAL(data.scanId, 0);
+
+	controller.getScan(data, false);
+	BOOST_CHECK(!data.duplicate);
+	BOOST_CHECK_EQUAL(data.scanId, 1);
+
+	// Flagged duplicates are parsed and keep the previous scan id
+	controller.duplicatePolicy = DuplicatePolicy::Flag;
+
+	controller.getScan(data, false);
+	BOOST_CHECK(!data.duplicate);
+	BOOST_CHECK_EQUAL(data.scanId, 2);
+
+	controller.getScan(data, false);
+	BOOST_CHECK(data.duplicate);
+	BOOST_CHECK_EQUAL(data.scanId, 2);
+	BOOST_CHECK_EQUAL(data.size(), NeatoController::LDS_SCAN_SIZE);
+
+	// Suppressed duplicates are not parsed at all
+	controller.duplicatePolicy = DuplicatePolicy::Suppress;
+
+	controller.getScan(data, false);
+	BOOST_CHECK(data.duplicate);
+	BOOST_CHECK(data.empty());
+	BOOST_CHECK_EQUAL(data.scanId, 2);
+
+	// A different response is parsed
+	std::stringstream otherLogStream("1$getldsscan\n$AngleInDegrees,DistInMM,Intensity,ErrorCodeHEX\n0,100,10,0\n$");
+	controller.setLog(std::make_shared<regilo::Log>(otherLogStream));
+
+	controller.getScan(data, false);
+	BOOST_CHECK(!data.duplicate);
+	BOOST_CHECK_EQUAL(data.scanId, 3);
+	BOOST_CHECK_EQUAL(data.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(NeatoControllerWaitForLds)
+{
+	std::string header = "AngleInDegrees,DistInMM,Intensity,ErrorCodeHEX\n";
+	std::stringstream logStream("1$getldsscan\n$" + header + "0,0,0,8035\n1,0,0,8035\nROTATION_SPEED,1.20\n"
+								"$getldsscan\n$" + header + "0,100,10,0\n1,0,0,8035\nROTATION_SPEED,4.90\n"
+								"$getldsscan\n$" + header + "0,100,10,0\n1,0,0,8035\nROTATION_SPEED,5.00\n"
+								"$getldsscan\n$" + header + "0,0,0,8035\n1,0,0,8035\nROTATION_SPEED,5.00\n$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = std::string(1, 0x1a);
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	regilo::NeatoSocketController controller;
+	controller.connect(simulator.getEndpoint());
+
+	// The speed is stable in the third scan
+	BOOST_CHECK(controller.waitForLds(std::chrono::seconds(10), 0.5, std::chrono::milliseconds(1)));
+
+	// Only one scan is polled without a timeout
+	BOOST_CHECK(!controller.waitForLds(std::chrono::milliseconds(0), 0.5, std::chrono::milliseconds(1)));
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+}
+
+BOOST_AUTO_TEST_CASE(NeatoControllerTelemetry)
+{
+	std::string scan = "AngleInDegrees,DistInMM,Intensity,ErrorCodeHEX\n0,100,10,0\nROTATION_SPEED,5.00\n";
+	std::string motors = "Parameter,Value\nLeftWheel_PositionInMM,10\nRightWheel_PositionInMM,20\n";
+	std::string charger = "Label,Value\nFuelPercent,83\n";
+
+	// The due sensors follow the scan in the same batch, the charger is not due in the second cycle
+	std::stringstream logStream("1$getldsscan\n$" + scan + "$getmotors\n$" + motors + "$getcharger\n$" + charger
+								+ "$getldsscan\n$" + scan + "$getmotors\n$" + motors + "$");
+	SocketSimulator simulator(logStream, 12345);
+	simulator.responseEnd = std::string(1, 0x1a);
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	regilo::NeatoSocketController controller;
+	controller.connect(simulator.getEndpoint());
+
+	controller.setTelemetryPeriod(regilo::NeatoSensor::Motors, std::chrono::milliseconds(1));
+	controller.setTelemetryPeriod(regilo::NeatoSensor::Charger, std::chrono::hours(1));
+	BOOST_CHECK(controller.getTelemetryPeriod(regilo::NeatoSensor::AnalogSensors) == std::chrono::milliseconds::zero());
+
+	regilo::ScanData data;
+	controller.getScan(data);
+	BOOST_CHECK_EQUAL(data.size(), 1);
+
+	const regilo::NeatoTelemetry& telemetry = controller.getTelemetry();
+	BOOST_CHECK_EQUAL(telemetry.motors.leftWheelPosition, 10);
+	BOOST_CHECK_EQUAL(telemetry.motors.rightWheelPosition, 20);
+	BOOST_CHECK_EQUAL(telemetry.charger.fuelPercent, 83);
+	BOOST_CHECK(telemetry.charger.time >= 0);
+	BOOST_CHECK_EQUAL(telemetry.analogSensors.time, -1);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	controller.getScan(data);
+	BOOST_CHECK_EQUAL(data.size(), 1);
+
+	// The scan is received before the motors of its batch, so it lies between the two motor samples
+	regilo::Pose pose;
+	BOOST_CHECK(controller.getOdometry().getPose(data.steadyTime, pose));
+	BOOST_CHECK_EQUAL(pose.x, 0);
+	BOOST_CHECK_EQUAL(pose.theta, 0);
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
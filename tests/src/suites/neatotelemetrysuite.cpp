@@ -0,0 +1,90 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/neatotelemetry.hpp"
+
+namespace {
+
+bool parseInParts(regilo::NeatoTelemetryParser& parser, const std::string& response, std::size_t partSize, regilo::NeatoSensorData& data)
+{
+	parser.begin(data);
+	for(std::size_t i = 0; i < response.size(); i += partSize)
+	{
+		const char *begin = response.data() + i;
+		parser.parse(begin, begin + std::min(partSize, response.size() - i));
+	}
+
+	return parser.end();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(NeatoTelemetrySuite)
+
+BOOST_AUTO_TEST_CASE(NeatoTelemetryMotors)
+{
+	std::string response = "Parameter,Value\r\nBrush_RPM,0\r\nLeftWheel_Load%,12\r\nLeftWheel_PositionInMM,-1534\r\n"
+						   "RightWheel_PositionInMM,1520\r\nRightWheel_Speed,150\r\nCharger_mAH, 0\r\n";
+
+	for(std::size_t partSize : { 1, 3, 7, 1000 })
+	{
+		regilo::NeatoMotors motors;
+		regilo::NeatoTelemetryParser parser;
+
+		BOOST_CHECK(parseInParts(parser, response, partSize, motors));
+		BOOST_CHECK_EQUAL(motors.leftWheelLoad, 12);
+		BOOST_CHECK_EQUAL(motors.leftWheelPosition, -1534);
+		BOOST_CHECK_EQUAL(motors.rightWheelPosition, 1520);
+		BOOST_CHECK_EQUAL(motors.rightWheelSpeed, 150);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(NeatoTelemetrySensors)
+{
+	regilo::NeatoTelemetry telemetry;
+	regilo::NeatoTelemetryParser parser;
+
+	// The value is the last column (the unit column is skipped)
+	BOOST_CHECK(parseInParts(parser, "SensorName,Unit,Value\nBatteryVoltageInmV,mV,16213\nAccelZInmG,mG,1004\n", 5,
+							 telemetry[regilo::NeatoSensor::AnalogSensors]));
+	BOOST_CHECK_EQUAL(telemetry.analogSensors.batteryVoltage, 16213);
+	BOOST_CHECK_EQUAL(telemetry.analogSensors.accelerationZ, 1004);
+
+	BOOST_CHECK(parseInParts(parser, "Digital Sensor Name, Value\nSNSR_DUSTBIN_IS_IN,1\nLFRONTBIT,1\nRFRONTBIT,0\n", 4,
+							 telemetry[regilo::NeatoSensor::DigitalSensors]));
+	BOOST_CHECK(telemetry.digitalSensors.dustbinIn);
+	BOOST_CHECK(telemetry.digitalSensors.leftFrontBumper);
+	BOOST_CHECK(!telemetry.digitalSensors.rightFrontBumper);
+
+	BOOST_CHECK(parseInParts(parser, "Label,Value\nFuelPercent,83\nVBattV,16.21\nExtPwrPresent,1", 100,
+							 telemetry[regilo::NeatoSensor::Charger]));
+	BOOST_CHECK_EQUAL(telemetry.charger.fuelPercent, 83);
+	BOOST_CHECK_CLOSE(telemetry.charger.batteryVoltage, 16.21, 1e-9);
+	BOOST_CHECK(telemetry.charger.externalPowerPresent);
+
+	// Unknown labels and invalid lines are skipped
+	BOOST_CHECK(!parseInParts(parser, "Parameter,Value\nUnknown,1\nBrush_RPM\nBrush_mA,abc\n", 100, telemetry.motors));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
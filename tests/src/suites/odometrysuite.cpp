@@ -0,0 +1,98 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <chrono>
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/odometry.hpp"
+
+namespace {
+
+regilo::Odometry::TimePoint at(long milliseconds)
+{
+	return regilo::Odometry::TimePoint(std::chrono::milliseconds(milliseconds));
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(OdometrySuite)
+
+BOOST_AUTO_TEST_CASE(OdometryIntegration)
+{
+	regilo::Odometry odometry(200);
+
+	// The first positions are only stored
+	odometry.update(at(0), 1000, 2000);
+	BOOST_CHECK_EQUAL(odometry.getPose().x, 0);
+
+	// Straight forward
+	odometry.update(at(100), 1100, 2100);
+	BOOST_CHECK_CLOSE(odometry.getPose().x, 100, 1e-9);
+	BOOST_CHECK_SMALL(odometry.getPose().y, 1e-9);
+
+	// Turning in place by 90 degrees to the left
+	double quarter = M_PI / 2 * 100;
+	odometry.update(at(200), 1100 - quarter, 2100 + quarter);
+	BOOST_CHECK_CLOSE(odometry.getPose().x, 100, 1e-9);
+	BOOST_CHECK_CLOSE(odometry.getPose().theta, M_PI / 2, 1e-9);
+
+	// Forward along the y axis
+	odometry.update(at(300), 1150 - quarter, 2150 + quarter);
+	BOOST_CHECK_CLOSE(odometry.getPose().x, 100, 1e-9);
+	BOOST_CHECK_CLOSE(odometry.getPose().y, 50, 1e-9);
+
+	odometry.reset(regilo::Pose(1, 2, 3));
+	odometry.update(at(400), 0, 0);
+	BOOST_CHECK_EQUAL(odometry.getPose().x, 1);
+	BOOST_CHECK_EQUAL(odometry.getPose().theta, 3);
+}
+
+BOOST_AUTO_TEST_CASE(OdometryInterpolation)
+{
+	regilo::Odometry odometry(200, 3);
+	regilo::Pose pose;
+
+	BOOST_CHECK(!odometry.getPose(at(0), pose));
+
+	odometry.update(at(0), 0, 0);
+	odometry.update(at(100), 100, 100);
+	odometry.update(at(200), 300, 300);
+
+	BOOST_REQUIRE(odometry.getPose(at(50), pose));
+	BOOST_CHECK_CLOSE(pose.x, 50, 1e-9);
+
+	BOOST_REQUIRE(odometry.getPose(at(175), pose));
+	BOOST_CHECK_CLOSE(pose.x, 250, 1e-9);
+
+	BOOST_REQUIRE(odometry.getPose(at(100), pose));
+	BOOST_CHECK_CLOSE(pose.x, 100, 1e-9);
+
+	BOOST_CHECK(!odometry.getPose(at(201), pose));
+
+	// The oldest pose is replaced
+	odometry.update(at(300), 400, 400);
+	BOOST_CHECK(!odometry.getPose(at(50), pose));
+	BOOST_REQUIRE(odometry.getPose(at(250), pose));
+	BOOST_CHECK_CLOSE(pose.x, 350, 1e-9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,148 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/neatocontroller.hpp"
+#include "regilo/scandatapool.hpp"
+
+#include "allocationcounter.hpp"
+
+struct ScanDataPoolFixture
+{
+	std::size_t size = 2;
+	std::size_t recordCapacity = 360;
+
+	regilo::ScanDataPool pool;
+
+	ScanDataPoolFixture() :
+		pool(size, recordCapacity)
+	{
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(ScanDataPoolSuite, ScanDataPoolFixture)
+
+BOOST_AUTO_TEST_CASE(ScanDataPoolConstructorValues)
+{
+	BOOST_CHECK_EQUAL(pool.getSize(), size);
+	BOOST_CHECK_EQUAL(pool.getFreeCount(), size);
+}
+
+BOOST_AUTO_TEST_CASE(ScanDataPoolRecycle)
+{
+	regilo::ScanData *rawData;
+
+	{
+		std::shared_ptr<regilo::ScanData> data = pool.acquire();
+		BOOST_REQUIRE(data->empty());
+		BOOST_CHECK_GE(data->capacity(), recordCapacity);
+		BOOST_CHECK_EQUAL(pool.getFreeCount(), size - 1);
+
+		data->scanId = 5;
+		data->resize(10);
+		rawData = data.get();
+	}
+
+	BOOST_CHECK_EQUAL(pool.getFreeCount(), size);
+
+	std::shared_ptr<regilo::ScanData> data = pool.acquire();
+	BOOST_CHECK_EQUAL(data.get(), rawData);
+	BOOST_CHECK(data->empty());
+	BOOST_CHECK_EQUAL(data->scanId, std::size_t(-1));
+}
+
+BOOST_AUTO_TEST_CASE(ScanDataPoolGrow)
+{
+	std::vector<std::shared_ptr<regilo::ScanData>> data;
+	for(std::size_t i = 0; i < size + 3; i++) data.push_back(pool.acquire());
+
+	BOOST_CHECK_EQUAL(pool.getSize(), size + 3);
+	BOOST_CHECK_EQUAL(pool.getFreeCount(), 0);
+
+	data.clear();
+	BOOST_CHECK_EQUAL(pool.getFreeCount(), size + 3);
+}
+
+BOOST_AUTO_TEST_CASE(ScanDataPoolSharedOwnership)
+{
+	std::shared_ptr<regilo::ScanData> data = pool.acquire();
+	std::shared_ptr<const regilo::ScanData> consumer1 = data;
+	std::shared_ptr<const regilo::ScanData> consumer2 = data;
+
+	data.reset();
+	consumer1.reset();
+	BOOST_CHECK_EQUAL(pool.getFreeCount(), size - 1);
+
+	consumer2.reset();
+	BOOST_CHECK_EQUAL(pool.getFreeCount(), size);
+}
+
+BOOST_AUTO_TEST_CASE(ScanDataPoolOutlive)
+{
+	std::shared_ptr<regilo::ScanData> data;
+
+	{
+		regilo::ScanDataPool localPool;
+		data = localPool.acquire();
+	}
+
+	data->resize(10);
+	BOOST_CHECK_EQUAL(data->size(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(ScanDataPoolNoAllocation)
+{
+	pool.acquire().reset();
+
+	AllocationCounter counter;
+	for(std::size_t i = 0; i < 10; i++)
+	{
+		std::shared_ptr<regilo::ScanData> data = pool.acquire();
+		std::shared_ptr<const regilo::ScanData> consumer = data;
+		data->resize(recordCapacity);
+	}
+
+	BOOST_CHECK_EQUAL(counter.count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ScanDataPoolGetScan)
+{
+	std::string correctScan;
+	std::ifstream dataFile("data/neato-correct-scan.txt");
+	std::getline(dataFile, correctScan, '\0');
+
+	regilo::NeatoSerialController controller("data/neato-log-scan-move-time.txt");
+
+	std::shared_ptr<regilo::ScanData> data = controller.getScan(pool, false);
+	BOOST_CHECK_EQUAL(pool.getFreeCount(), size - 1);
+
+	std::ostringstream scanStream;
+	scanStream << *data;
+
+	BOOST_CHECK_EQUAL(scanStream.str(), correctScan);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
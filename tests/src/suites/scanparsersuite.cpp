@@ -0,0 +1,187 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/hokuyocontroller.hpp"
+#include "regilo/hokuyoscanparser.hpp"
+#include "regilo/log.hpp"
+#include "regilo/neatocontroller.hpp"
+#include "regilo/neatoscanparser.hpp"
+
+namespace {
+
+std::string readResponse(const std::string& logPath, const std::string& command)
+{
+	regilo::Log log(logPath);
+	return log.readCommand(command);
+}
+
+bool parseInParts(regilo::ScanParser& parser, const std::string& response, std::size_t partSize, regilo::ScanData& data)
+{
+	parser.begin(data);
+	for(std::size_t i = 0; i < response.size(); i += partSize)
+	{
+		const char *begin = response.data() + i;
+		parser.parse(begin, begin + std::min(partSize, response.size() - i));
+	}
+
+	return parser.end();
+}
+
+void checkEqualData(const regilo::ScanData& data, const regilo::ScanData& expectedData)
+{
+	BOOST_REQUIRE_EQUAL(data.size(), expectedData.size());
+	BOOST_CHECK_EQUAL(data.rotationSpeed, expectedData.rotationSpeed);
+	BOOST_CHECK(data.angleTable == expectedData.angleTable);
+
+	for(std::size_t i = 0; i < data.size(); i++)
+	{
+		BOOST_CHECK_EQUAL(data[i].id, expectedData[i].id);
+		BOOST_CHECK_EQUAL(data[i].angle, expectedData[i].angle);
+		BOOST_CHECK_EQUAL(data[i].distance, expectedData[i].distance);
+		BOOST_CHECK_EQUAL(data[i].intensity, expectedData[i].intensity);
+		BOOST_CHECK_EQUAL(data[i].errorCode, expectedData[i].errorCode);
+		BOOST_CHECK_EQUAL(data[i].error, expectedData[i].error);
+	}
+}
+
+regilo::NeatoScanParser createNeatoParser()
+{
+	return regilo::NeatoScanParser(regilo::NeatoSerialController::LDS_SCAN_HEADER, regilo::NeatoSerialController::LDS_SCAN_FOOTER,
+								   regilo::NeatoSerialController::LDS_ANGLE_TABLE);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(ScanParserSuite)
+
+BOOST_AUTO_TEST_CASE(ScanParserNeatoParts)
+{
+	std::string response = readResponse("data/neato-log-scan-move-time.txt", "getldsscan");
+
+	regilo::NeatoSerialController controller("data/neato-log-scan-move-time.txt");
+	regilo::ScanData expectedData = controller.getScan(false);
+	BOOST_REQUIRE_EQUAL(expectedData.size(), 360);
+
+	regilo::NeatoScanParser parser = createNeatoParser();
+	for(std::size_t partSize : { std::size_t(1), std::size_t(7), std::size_t(64), response.size() })
+	{
+		regilo::ScanData data;
+		BOOST_CHECK(parseInParts(parser, response, partSize, data));
+		checkEqualData(data, expectedData);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ScanParserNeatoInvalid)
+{
+	regilo::NeatoScanParser parser = createNeatoParser();
+	regilo::ScanData data;
+
+	BOOST_CHECK(!parseInParts(parser, "Unknown command\r\n", 4, data));
+	BOOST_CHECK(data.empty());
+
+	std::string header = regilo::NeatoSerialController::LDS_SCAN_HEADER;
+	BOOST_CHECK(!parseInParts(parser, header + "\r\n0,100,10,0\r\n1,abc\r\nROTATION_SPEED,5.00\r\n", 3, data));
+	BOOST_CHECK_EQUAL(data.size(), 1);
+
+	data.reset();
+	BOOST_CHECK(!parseInParts(parser, header + "\r\n0,100,10,0\r\n", 5, data));
+	BOOST_CHECK_EQUAL(data.size(), 1);
+
+	data.reset();
+	BOOST_CHECK(parseInParts(parser, header + "\r\n0,100,10,0\r\n1,0,0,8035\r\nROTATION_SPEED,5.00", 5, data));
+	BOOST_REQUIRE_EQUAL(data.size(), 2);
+	BOOST_CHECK_EQUAL(data.rotationSpeed, 5);
+	BOOST_CHECK(data.at(1).error);
+	BOOST_CHECK_EQUAL(data.at(1).errorCode, 8035);
+}
+
+BOOST_AUTO_TEST_CASE(ScanParserHokuyoParts)
+{
+	std::string response = readResponse("data/hokuyo-log-scan-version.txt", "G00076801");
+
+	regilo::HokuyoSerialController controller("data/hokuyo-log-scan-version.txt");
+	regilo::ScanData expectedData = controller.getScan(false);
+	BOOST_REQUIRE(!expectedData.empty());
+
+	regilo::HokuyoScanParser parser;
+	parser.setParameters(0, 1, 44, 725, 20, M_PI / 512, -135 * M_PI / 180, controller.getAngleTable());
+
+	for(std::size_t partSize : { std::size_t(1), std::size_t(3), std::size_t(65), response.size() })
+	{
+		regilo::ScanData data;
+		BOOST_CHECK(parseInParts(parser, response, partSize, data));
+		checkEqualData(data, expectedData);
+	}
+
+	regilo::ScanData data;
+	BOOST_CHECK(!parseInParts(parser, "1\n", 1, data));
+	BOOST_CHECK(!parseInParts(parser, "", 1, data));
+}
+
+BOOST_AUTO_TEST_CASE(ScanParserSectors)
+{
+	std::string response = readResponse("data/neato-log-scan-move-time.txt", "getldsscan");
+	regilo::NeatoScanParser parser = createNeatoParser();
+
+	std::vector<std::pair<std::size_t, std::size_t>> sectors;
+	parser.setSectorCallback(100, [&sectors] (const regilo::ScanData& data, std::size_t from, std::size_t to)
+	{
+		BOOST_CHECK_EQUAL(data.size(), to);
+		sectors.emplace_back(from, to);
+	});
+
+	regilo::ScanData data;
+	BOOST_CHECK(parseInParts(parser, response, 50, data));
+
+	BOOST_REQUIRE_EQUAL(sectors.size(), 4);
+	BOOST_CHECK_EQUAL(sectors.at(0).first, 0);
+	BOOST_CHECK_EQUAL(sectors.at(0).second, 100);
+	BOOST_CHECK_EQUAL(sectors.at(2).second, 300);
+	BOOST_CHECK_EQUAL(sectors.at(3).first, 300);
+	BOOST_CHECK_EQUAL(sectors.at(3).second, 360);
+
+	sectors.clear();
+	parser.setSectorCallback(0, nullptr);
+	BOOST_CHECK(parseInParts(parser, response, 50, data));
+	BOOST_CHECK(sectors.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ScanParserControllerSectors)
+{
+	regilo::HokuyoSerialController controller("data/hokuyo-log-scan-version.txt");
+
+	std::size_t records = 0;
+	controller.setSectorCallback(64, [&records] (const regilo::ScanData&, std::size_t from, std::size_t to)
+	{
+		BOOST_CHECK_EQUAL(from, records);
+		records = to;
+	});
+
+	regilo::ScanData data = controller.getScan(false);
+	BOOST_CHECK_EQUAL(records, data.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+/*
+ * Regilo
+ * Copyright (C) 2015-2016  Branislav Holý <branoholy@gmail.com>
+ *
+ * This file is part of Regilo.
+ *
+ * Regilo is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Regilo is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Regilo.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include "regilo/neatocontroller.hpp"
+#include "regilo/scanpollscheduler.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+// A simulated LDS: rotations end at offset + k * period
+struct Rotation
+{
+	Clock::time_point offset;
+	Clock::duration period;
+
+	inline long index(Clock::time_point time) const { return long(std::floor(double((time - offset).count()) / period.count())); }
+	inline Clock::time_point end(long index) const { return offset + index * period; }
+};
+
+BOOST_AUTO_TEST_SUITE(ScanPollSchedulerSuite)
+
+BOOST_AUTO_TEST_CASE(ScanPollSchedulerPhaseLock)
+{
+	regilo::NeatoSerialController controller;
+	regilo::ScanPollScheduler scheduler(controller, 5, std::chrono::milliseconds(5));
+
+	BOOST_CHECK(scheduler.getPeriod() == std::chrono::milliseconds(200));
+
+	// The device rotates a bit faster than expected (it reports 5.05 Hz)
+	Rotation rotation { Clock::time_point() + std::chrono::milliseconds(1037), std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / 5.05)) };
+
+	Clock::time_point time = Clock::time_point() + std::chrono::seconds(1);
+	long lastRotation = rotation.index(time) - 1;
+
+	std::size_t rotations = 0;
+	std::size_t lockedStalePolls = 0;
+	Clock::duration maxAge = Clock::duration::zero();
+
+	for(std::size_t i = 0; i < 500; i++)
+	{
+		long current = rotation.index(time);
+		bool newRotation = (current > lastRotation);
+		if(newRotation)
+		{
+			lastRotation = current;
+			rotations++;
+
+			if(rotations > 20) maxAge = std::max(maxAge, time - rotation.end(current));
+		}
+		else if(rotations > 20) lockedStalePolls++;
+
+		time = scheduler.update(time, newRotation, 5.05);
+	}
+
+	BOOST_CHECK_EQUAL(scheduler.getPolls(), 500);
+
+	// Every rotation is polled and the polls are close to the ends of the rotations
+	BOOST_CHECK(rotations > 400);
+	BOOST_CHECK(maxAge <= std::chrono::milliseconds(10));
+	BOOST_CHECK(lockedStalePolls * 4 < rotations);
+}
+
+BOOST_AUTO_TEST_CASE(ScanPollSchedulerStaleRetry)
+{
+	regilo::NeatoSerialController controller;
+	regilo::ScanPollScheduler scheduler(controller, 5, std::chrono::milliseconds(5));
+
+	Clock::time_point time = Clock::time_point() + std::chrono::seconds(1);
+
+	// The first new rotation, then the next poll is earlier by a quarter of the period
+	Clock::time_point next = scheduler.update(time, true, -1);
+	BOOST_CHECK(next - time == std::chrono::milliseconds(150));
+
+	// A stale poll is repeated after the step
+	Clock::time_point retry = scheduler.update(next, false, -1);
+	BOOST_CHECK(retry - next == std::chrono::milliseconds(50));
+	BOOST_CHECK_EQUAL(scheduler.getStalePolls(), 1);
+
+	// The rotation end is found, the next poll is one period later
+	Clock::time_point locked = scheduler.update(retry, true, -1);
+	BOOST_CHECK(locked - retry == std::chrono::milliseconds(200));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
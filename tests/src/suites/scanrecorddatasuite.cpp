@@ -19,6 +19,7 @@
  *
  */
 
+#include <cmath>
 #include <iostream>
 #include <sstream>
 
@@ -97,6 +98,19 @@ BOOST_AUTO_TEST_CASE(ScanDataConstructorValues)
 	BOOST_REQUIRE(data.rotationSpeed == rotationSpeed);
 }
 
+BOOST_AUTO_TEST_CASE(ScanDataReset)
+{
+	std::size_t capacity = data.capacity();
+	data.time = 123;
+	data.reset();
+
+	BOOST_REQUIRE(data.empty());
+	BOOST_REQUIRE(data.capacity() == capacity);
+	BOOST_REQUIRE(data.scanId == std::size_t(-1));
+	BOOST_REQUIRE(data.rotationSpeed == double(-1));
+	BOOST_REQUIRE(data.time == 0);
+}
+
 BOOST_AUTO_TEST_CASE(ScanDataPrint)
 {
 	std::ostringstream out, correct;
@@ -19,6 +19,7 @@
  *
  */
 
+#include <chrono>
 #include <iostream>
 #include <mutex>
 #include <sstream>
@@ -31,6 +32,7 @@
 
 #include "regilo/serialcontroller.hpp"
 #include "regilo/socketcontroller.hpp"
+#include "regilo/timeouterror.hpp"
 
 #include "simulators/serialsimulator.hpp"
 #include "simulators/socketsimulator.hpp"
@@ -55,6 +57,13 @@ struct StreamControllerFixture
 	inline const StreamController* getFileController() const { return controllers.at(0); }
 };
 
+template<typename StreamController>
+class BatchController : public StreamController
+{
+public:
+	using StreamController::sendCommandsStreamed;
+};
+
 typedef boost::mpl::vector<regilo::SerialController, regilo::SocketController> StreamControllers;
 
 BOOST_AUTO_TEST_SUITE(StreamControllerSuite)
@@ -140,4 +149,158 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(StreamControllerCommunication, StreamController
 	BOOST_CHECK(deviceStatus);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(StreamControllerBatch, StreamController, StreamControllers, SF)
+{
+	std::stringstream logStream("1$CMD1\n$RESPONSE1$CMD 2\n$RESPONSE2$V\n$2.5$");
+
+	Simulator *simulator = nullptr;
+	if(std::is_same<StreamController, regilo::SerialController>::value) simulator = new SerialSimulator(logStream);
+	else simulator = new SocketSimulator(logStream, 12345);
+
+	simulator->start();
+
+	bool deviceStatus = false;
+	std::thread deviceThread([simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator->run();
+	});
+
+	{
+		BatchController<StreamController> controller;
+		controller.connect(simulator->getEndpoint());
+		BOOST_REQUIRE(controller.isConnected());
+
+		std::vector<regilo::CommandBuffer> commands = { std::string("CMD1"), std::string("CMD 2"), std::string("V") };
+		std::vector<std::string> responses(commands.size());
+
+		controller.sendCommandsStreamed(commands.data(), commands.size(), [&responses] (std::size_t index, const char *begin, const char *end)
+		{
+			responses.at(index).append(begin, end);
+		});
+
+		BOOST_CHECK_EQUAL(responses.at(0), "RESPONSE1");
+		BOOST_CHECK_EQUAL(responses.at(1), "RESPONSE2");
+		BOOST_CHECK_EQUAL(responses.at(2), "2.5");
+	}
+
+	if(deviceThread.joinable()) deviceThread.join();
+	delete simulator;
+
+	BOOST_CHECK(deviceStatus);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(StreamControllerTimeout, StreamController, StreamControllers, SF)
+{
+	std::stringstream logStream("1$CMD1\n$RESPONSE1$CMD2\n$RESPONSE2$");
+
+	Simulator *simulator = nullptr;
+	if(std::is_same<StreamController, regilo::SerialController>::value) simulator = new SerialSimulator(logStream);
+	else simulator = new SocketSimulator(logStream, 12345);
+
+	simulator->start();
+
+	bool deviceStatus = false;
+	std::thread deviceThread;
+
+	{
+		StreamController controller;
+		controller.connect(simulator->getEndpoint());
+		BOOST_REQUIRE(controller.isConnected());
+
+		// The simulator does not run yet, so the device does not respond
+		controller.timeout = std::chrono::milliseconds(100);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		try
+		{
+			controller.sendCommand("CMD1");
+			BOOST_ERROR("TimeoutError was not thrown.");
+		}
+		catch(regilo::TimeoutError& e)
+		{
+			BOOST_CHECK(e.code() == boost::asio::error::timed_out);
+		}
+		std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+		BOOST_CHECK(elapsed >= std::chrono::milliseconds(100));
+		BOOST_CHECK(elapsed < std::chrono::milliseconds(1000));
+
+		deviceThread = std::thread([simulator, &deviceStatus] ()
+		{
+			deviceStatus = simulator->run();
+		});
+
+		// Wait for the late response to the timed out command, the next command has to skip it
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+		controller.timeout = std::chrono::milliseconds::zero();
+		std::string response = controller.template sendCommand<std::string>(regilo::CommandBuffer("CMD2"), std::chrono::milliseconds(1000));
+		BOOST_CHECK_EQUAL(response, "RESPONSE2");
+	}
+
+	if(deviceThread.joinable()) deviceThread.join();
+	delete simulator;
+
+	BOOST_CHECK(deviceStatus);
+}
+
+BOOST_AUTO_TEST_CASE(StreamControllerReconnect)
+{
+	regilo::SocketController controller;
+	controller.reconnectPolicy.maxAttempts = 5;
+	controller.reconnectPolicy.initialDelay = std::chrono::milliseconds(10);
+
+	{
+		std::stringstream logStream("1$CMD1\n$RESPONSE1$");
+		SocketSimulator simulator(logStream, 12345);
+
+		bool deviceStatus = false;
+		std::thread deviceThread([&simulator, &deviceStatus] ()
+		{
+			deviceStatus = simulator.run();
+		});
+
+		controller.connect(simulator.getEndpoint());
+		BOOST_CHECK_EQUAL(controller.sendCommand<std::string>("CMD1"), "RESPONSE1");
+
+		if(deviceThread.joinable()) deviceThread.join();
+		BOOST_CHECK(deviceStatus);
+	}
+
+	// The first device is gone, the same endpoint is served by a new one
+	std::stringstream logStream("1$CMD2\n$RESPONSE2$");
+	SocketSimulator simulator(logStream, 12345);
+
+	bool deviceStatus = false;
+	std::thread deviceThread([&simulator, &deviceStatus] ()
+	{
+		deviceStatus = simulator.run();
+	});
+
+	BOOST_CHECK_EQUAL(controller.sendCommand<std::string>("CMD2"), "RESPONSE2");
+
+	const regilo::ConnectionStats& stats = controller.getConnectionStats();
+	BOOST_CHECK_EQUAL(stats.disconnects, 1);
+	BOOST_CHECK_EQUAL(stats.reconnects, 1);
+	BOOST_CHECK(stats.attempts >= 1);
+	BOOST_CHECK(stats.lastDowntime >= std::chrono::milliseconds(10));
+	BOOST_CHECK(stats.totalDowntime == stats.lastDowntime);
+
+	if(deviceThread.joinable()) deviceThread.join();
+	BOOST_CHECK(deviceStatus);
+}
+
+BOOST_AUTO_TEST_CASE(StreamControllerReconnectBackoff)
+{
+	regilo::ReconnectPolicy policy;
+	policy.initialDelay = std::chrono::milliseconds(100);
+	policy.maxDelay = std::chrono::milliseconds(1000);
+
+	BOOST_CHECK(policy.getDelay(0) == std::chrono::milliseconds(100));
+	BOOST_CHECK(policy.getDelay(1) == std::chrono::milliseconds(200));
+	BOOST_CHECK(policy.getDelay(3) == std::chrono::milliseconds(800));
+	BOOST_CHECK(policy.getDelay(4) == std::chrono::milliseconds(1000));
+	BOOST_CHECK(policy.getDelay(100) == std::chrono::milliseconds(1000));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
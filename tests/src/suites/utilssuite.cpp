@@ -21,10 +21,13 @@
 
 #include <chrono>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 #include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include "regilo/delimitermatcher.hpp"
 #include "regilo/utils.hpp"
 
 BOOST_AUTO_TEST_SUITE(UtilsSuite)
@@ -45,4 +48,90 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(TimeSinceEpoch, T, TimeTypes)
 	BOOST_REQUIRE(timeAfter >= time);
 }
 
+BOOST_AUTO_TEST_CASE(DelimiterMatcherFind)
+{
+	std::string data = "xaaab-aab";
+	regilo::DelimiterMatcher matcher("aab");
+
+	const char *found = matcher.find(data.data(), data.data() + data.size());
+	BOOST_REQUIRE(found != nullptr);
+	BOOST_CHECK_EQUAL(found - data.data(), 5);
+
+	found = matcher.find(found, data.data() + data.size());
+	BOOST_REQUIRE(found != nullptr);
+	BOOST_CHECK_EQUAL(found - data.data(), 9);
+
+	BOOST_CHECK(matcher.find(data.data(), data.data() + 1) == nullptr);
+	BOOST_CHECK_EQUAL(matcher.getMatchedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(DelimiterMatcherParts)
+{
+	std::string data = "abc\nab\n\n\ncd";
+	regilo::DelimiterMatcher matcher("\n\n");
+
+	std::size_t foundPosition = 0;
+	for(std::size_t i = 0; i < data.size() && foundPosition == 0; i++)
+	{
+		const char *part = data.data() + i;
+		const char *found = matcher.find(part, part + 1);
+
+		if(found != nullptr) foundPosition = found - data.data();
+		else if(data[i] == '\n') BOOST_CHECK_EQUAL(matcher.getMatchedSize(), 1);
+	}
+
+	BOOST_CHECK_EQUAL(foundPosition, 8);
+
+	matcher.setDelimiter("abab");
+	std::string overlap = "ababab";
+	BOOST_CHECK(matcher.find(overlap.data(), overlap.data() + 3) == nullptr);
+	BOOST_CHECK_EQUAL(matcher.getMatchedSize(), 3);
+	BOOST_CHECK(matcher.find(overlap.data() + 3, overlap.data() + 4) != nullptr);
+
+	matcher.reset();
+	BOOST_CHECK(matcher.find(overlap.data() + 1, overlap.data() + 6) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(DelimiterMatcherCondition)
+{
+	std::string data = "G00076801\n0\nabc\n\nnext";
+	regilo::DelimiterMatcher matcher("\n\n");
+	regilo::DelimiterMatcher::Condition condition = matcher.condition();
+
+	std::pair<std::string::iterator, bool> result = condition(data.begin(), data.begin() + 15);
+	BOOST_CHECK(!result.second);
+	BOOST_CHECK(result.first == data.begin() + 15);
+
+	result = condition(result.first, data.end());
+	BOOST_CHECK(result.second);
+	BOOST_CHECK(result.first == data.begin() + 17);
+
+	BOOST_CHECK(boost::asio::is_match_condition<regilo::DelimiterMatcher::Condition>::value);
+}
+
+BOOST_AUTO_TEST_CASE(GetLineDelimiters)
+{
+	std::istringstream stream("first\n\nsec\nond\n\n\nthird");
+	std::string line;
+
+	BOOST_CHECK(regilo::getLine(stream, line, "\n\n"));
+	BOOST_CHECK_EQUAL(line, "first");
+
+	BOOST_CHECK(regilo::getLine(stream, line, "\n\n"));
+	BOOST_CHECK_EQUAL(line, "sec\nond");
+
+	BOOST_CHECK(regilo::getLine(stream, line, "\n\n"));
+	BOOST_CHECK_EQUAL(line, "\nthird");
+	BOOST_CHECK(stream.eof());
+
+	BOOST_CHECK(!regilo::getLine(stream, line, "\n\n"));
+
+	std::istringstream overlapStream("xaaab-aab");
+	BOOST_CHECK(regilo::getLine(overlapStream, line, "aab"));
+	BOOST_CHECK_EQUAL(line, "xa");
+
+	BOOST_CHECK(regilo::getLine(overlapStream, line, "aab"));
+	BOOST_CHECK_EQUAL(line, "-");
+}
+
 BOOST_AUTO_TEST_SUITE_END()